@@ -0,0 +1,29 @@
+set(BENCHMARK_WARMUP_FRAMES 100 CACHE STRING "Frames vor der Messung")
+set(BENCHMARK_FRAMES 1000 CACHE STRING "Gemessene Frames pro Beispiel")
+set(BENCHMARK_OUTPUT_DIR ${CMAKE_BINARY_DIR}/benchmark CACHE PATH "Verzeichnis für die JSON-Ergebnisse")
+
+function(add_benchmark_target)
+
+    file(MAKE_DIRECTORY ${BENCHMARK_OUTPUT_DIR})
+
+    set(BENCHMARK_COMMANDS)
+
+    # Die Beispiele laden ihre Shader relativ zum Arbeitsverzeichnis
+    foreach(TARGET_NAME ${ARGN})
+        list(APPEND BENCHMARK_COMMANDS
+                COMMAND ${CMAKE_COMMAND} -E chdir $<TARGET_FILE_DIR:${TARGET_NAME}>
+                $<TARGET_FILE:${TARGET_NAME}>
+                --benchmark ${BENCHMARK_OUTPUT_DIR}/${TARGET_NAME}.json
+                --warmup ${BENCHMARK_WARMUP_FRAMES}
+                --frames ${BENCHMARK_FRAMES}
+        )
+    endforeach()
+
+    add_custom_target(benchmark
+            ${BENCHMARK_COMMANDS}
+            DEPENDS ${ARGN}
+            COMMENT "Running benchmarks -> ${BENCHMARK_OUTPUT_DIR}"
+            VERBATIM
+    )
+
+endfunction()
@@ -5,6 +5,7 @@ function(compile_shaders TARGET_NAME)
     file(GLOB SHADERS
             ${SHADER_SRC_DIR}/*.vert
             ${SHADER_SRC_DIR}/*.frag
+            ${SHADER_SRC_DIR}/*.comp
     )
 
     set(SPIRV_OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/shaders)
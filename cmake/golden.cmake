@@ -0,0 +1,47 @@
+set(GOLDEN_FRAMES 60 CACHE STRING "Frames pro Golden Image Test, verglichen wird das letzte")
+set(GOLDEN_TOLERANCE 2 CACHE STRING "Erlaubte Abweichung pro Farbkanal")
+
+# Ein CTest pro Beispiel: headless rendern und das letzte Frame mit
+# examples/<name>/golden/<name>.ppm vergleichen. Die Referenzbilder schreibt
+# das Target update_golden neu, danach werden sie mit eingecheckt. Ohne
+# Referenzbild wird kein Test angelegt, nach update_golden cmake erneut ausführen.
+function(add_golden_tests)
+
+    set(UPDATE_COMMANDS)
+
+    # Die Beispiele laden ihre Shader relativ zum Arbeitsverzeichnis
+    foreach(TARGET_NAME ${ARGN})
+        set(GOLDEN_DIR ${CMAKE_SOURCE_DIR}/examples/${TARGET_NAME}/golden)
+        set(GOLDEN_IMAGE ${GOLDEN_DIR}/${TARGET_NAME}.ppm)
+
+        if(EXISTS ${GOLDEN_IMAGE})
+            add_test(NAME golden_${TARGET_NAME}
+                    COMMAND ${CMAKE_COMMAND} -E chdir $<TARGET_FILE_DIR:${TARGET_NAME}>
+                    $<TARGET_FILE:${TARGET_NAME}>
+                    --headless
+                    --frames ${GOLDEN_FRAMES}
+                    --golden ${GOLDEN_IMAGE}
+                    --golden-tolerance ${GOLDEN_TOLERANCE}
+            )
+        else()
+            message(STATUS "Kein Referenzbild für ${TARGET_NAME}, golden_${TARGET_NAME} wird übersprungen")
+        endif()
+
+        list(APPEND UPDATE_COMMANDS
+                COMMAND ${CMAKE_COMMAND} -E make_directory ${GOLDEN_DIR}
+                COMMAND ${CMAKE_COMMAND} -E chdir $<TARGET_FILE_DIR:${TARGET_NAME}>
+                $<TARGET_FILE:${TARGET_NAME}>
+                --headless
+                --frames ${GOLDEN_FRAMES}
+                --write-golden ${GOLDEN_IMAGE}
+        )
+    endforeach()
+
+    add_custom_target(update_golden
+            ${UPDATE_COMMANDS}
+            DEPENDS ${ARGN}
+            COMMENT "Writing golden images -> examples/<name>/golden"
+            VERBATIM
+    )
+
+endfunction()
@@ -0,0 +1,166 @@
+#ifndef BARRIER_BATCH_H
+#define BARRIER_BATCH_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "DeviceDispatch.h"
+
+struct BarrierBatchStats {
+    uint64_t barrierCalls = 0;
+    uint64_t imageBarriers = 0;
+    uint64_t frames = 0;
+};
+
+// Sammelt Image-Layout-Übergänge und gibt sie an Pass-Grenzen mit einem einzigen
+// vkCmdPipelineBarrier2 aus (VK_KHR_synchronization2). Ohne die Extension werden sie
+// zu einem einzigen klassischen vkCmdPipelineBarrier zusammengefasst, dessen Stage Masks
+// die Vereinigung aller Übergänge sind.
+class BarrierBatch {
+
+    private:
+        bool synchronization2 = false;
+
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
+        std::vector<VkImageMemoryBarrier> legacyImageBarriers;
+
+        BarrierBatchStats stats;
+
+    public:
+        // synchronization2 nur setzen, wenn das Feature am Device aktiviert ist.
+        void create(bool synchronization2);
+
+        bool usesSynchronization2() const;
+
+        // Merkt sich den Übergang, aufgezeichnet wird er erst mit flush().
+        void imageTransition(VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 srcAccessMask, VkAccessFlags2 dstAccessMask, VkImageLayout oldLayout, VkImageLayout newLayout, VkImage image, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+
+        // Zeichnet alle gesammelten Übergänge mit einem Aufruf auf, ohne Übergänge passiert nichts.
+        void flush(VkCommandBuffer commandBuffer);
+
+        // Einmal pro Frame aufrufen, damit getStats() Werte pro Frame liefern kann.
+        void endFrame();
+
+        BarrierBatchStats getStats() const;
+
+    private:
+        static VkPipelineStageFlags toLegacyStages(VkPipelineStageFlags2 stages, VkPipelineStageFlags none);
+        static VkAccessFlags toLegacyAccess(VkAccessFlags2 access);
+};
+
+inline void BarrierBatch::create(bool synchronization2) {
+    this->synchronization2 = synchronization2;
+}
+
+inline bool BarrierBatch::usesSynchronization2() const {
+    return synchronization2;
+}
+
+inline void BarrierBatch::imageTransition(VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 srcAccessMask, VkAccessFlags2 dstAccessMask, VkImageLayout oldLayout, VkImageLayout newLayout, VkImage image, VkImageAspectFlags aspectMask) {
+
+    VkImageMemoryBarrier2 imageMemoryBarrier {};
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    imageMemoryBarrier.pNext = nullptr;
+    imageMemoryBarrier.srcStageMask = srcStageMask;
+    imageMemoryBarrier.srcAccessMask = srcAccessMask;
+    imageMemoryBarrier.dstStageMask = dstStageMask;
+    imageMemoryBarrier.dstAccessMask = dstAccessMask;
+    imageMemoryBarrier.oldLayout = oldLayout;
+    imageMemoryBarrier.newLayout = newLayout;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image = image;
+    imageMemoryBarrier.subresourceRange.aspectMask = aspectMask;
+    imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
+    imageMemoryBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+    imageMemoryBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+    imageBarriers.push_back(imageMemoryBarrier);
+}
+
+inline VkPipelineStageFlags BarrierBatch::toLegacyStages(VkPipelineStageFlags2 stages, VkPipelineStageFlags none) {
+
+    // Die klassischen Barrieren kennen keine leere Stage Mask
+    if (stages == VK_PIPELINE_STAGE_2_NONE) {
+        return none;
+    }
+
+    // Die unteren 32 Bit stimmen mit den klassischen Stages überein, alles darüber gibt es nur in synchronization2
+    if (stages >> 32) {
+        return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
+
+    return static_cast<VkPipelineStageFlags>(stages);
+}
+
+inline VkAccessFlags BarrierBatch::toLegacyAccess(VkAccessFlags2 access) {
+
+    if (access >> 32) {
+        return VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    }
+
+    return static_cast<VkAccessFlags>(access);
+}
+
+inline void BarrierBatch::flush(VkCommandBuffer commandBuffer) {
+
+    if (imageBarriers.empty()) {
+        return;
+    }
+
+    stats.barrierCalls++;
+    stats.imageBarriers += imageBarriers.size();
+
+    if (synchronization2) {
+
+        VkDependencyInfo dependencyInfo {};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.pNext = nullptr;
+        dependencyInfo.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+
+        deviceDispatch.vkCmdPipelineBarrier2KHR(commandBuffer, &dependencyInfo);
+        imageBarriers.clear();
+        return;
+    }
+
+    VkPipelineStageFlags srcStageMask = 0;
+    VkPipelineStageFlags dstStageMask = 0;
+    legacyImageBarriers.clear();
+
+    for (const VkImageMemoryBarrier2& barrier : imageBarriers) {
+
+        srcStageMask |= toLegacyStages(barrier.srcStageMask, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        dstStageMask |= toLegacyStages(barrier.dstStageMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        VkImageMemoryBarrier imageMemoryBarrier {};
+        imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageMemoryBarrier.pNext = nullptr;
+        imageMemoryBarrier.srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+        imageMemoryBarrier.dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+        imageMemoryBarrier.oldLayout = barrier.oldLayout;
+        imageMemoryBarrier.newLayout = barrier.newLayout;
+        imageMemoryBarrier.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        imageMemoryBarrier.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        imageMemoryBarrier.image = barrier.image;
+        imageMemoryBarrier.subresourceRange = barrier.subresourceRange;
+
+        legacyImageBarriers.push_back(imageMemoryBarrier);
+    }
+
+    deviceDispatch.vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, VK_DEPENDENCY_BY_REGION_BIT, 0, nullptr, 0, nullptr, static_cast<uint32_t>(legacyImageBarriers.size()), legacyImageBarriers.data());
+    imageBarriers.clear();
+}
+
+inline void BarrierBatch::endFrame() {
+    stats.frames++;
+}
+
+inline BarrierBatchStats BarrierBatch::getStats() const {
+    return stats;
+}
+
+#endif //BARRIER_BATCH_H
@@ -0,0 +1,151 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "GpuProfiler.h"
+#include "Headless.h"
+#include "MemoryTypes.h"
+
+// Die Beispiele erhöhen die Zähler direkt nach dem jeweiligen Vulkan-Aufruf.
+// Allokationen zählt der MemoryTypeSelector, über den jeder Speicher reserviert wird.
+struct BenchmarkCounters {
+    uint64_t submits = 0;
+};
+
+inline BenchmarkCounters benchmarkCounters;
+
+struct BenchmarkTimings {
+    double minMs = 0.0;
+    double avgMs = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+inline BenchmarkTimings computeBenchmarkTimings(std::vector<double> samples) {
+
+    BenchmarkTimings timings {};
+    if (samples.empty()) {
+        return timings;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+
+    const auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(static_cast<double>(samples.size()) * p))];
+    };
+
+    timings.minMs = samples.front();
+    timings.avgMs = sum / static_cast<double>(samples.size());
+    timings.p50Ms = percentile(0.5);
+    timings.p99Ms = percentile(0.99);
+    timings.maxMs = samples.back();
+
+    return timings;
+}
+
+// Schreibt das Ergebnis eines Laufs als JSON. Die GPU-Mittelwerte beziehen sich auf alle
+// gemessenen Frames, min und p99 auf die letzten GpuProfiler::HISTORY_SIZE Frames.
+inline bool writeBenchmarkJson(const std::string& path, std::string_view name, const HeadlessOptions& options, double seconds, const BenchmarkTimings& cpuTimings,
+                               const std::vector<GpuScopeStats>& gpuStats, const BenchmarkCounters& total, const BenchmarkCounters& measured,
+                               uint64_t totalAllocations, uint64_t measuredAllocations) {
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const double frames = static_cast<double>(std::max(options.frameCount, 1u));
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n";
+    file << "  \"example\": \"" << name << "\",\n";
+    file << "  \"warmupFrames\": " << options.warmupFrames << ",\n";
+    file << "  \"measuredFrames\": " << options.frameCount << ",\n";
+    file << "  \"seconds\": " << seconds << ",\n";
+    file << "  \"fps\": " << (seconds > 0.0 ? options.frameCount / seconds : 0.0) << ",\n";
+    file << "  \"cpuFrameMs\": { \"min\": " << cpuTimings.minMs << ", \"avg\": " << cpuTimings.avgMs << ", \"p50\": " << cpuTimings.p50Ms
+         << ", \"p99\": " << cpuTimings.p99Ms << ", \"max\": " << cpuTimings.maxMs << " },\n";
+
+    file << "  \"gpuMs\": [";
+    for (size_t i = 0; i < gpuStats.size(); i++) {
+        const GpuScopeStats& scope = gpuStats[i];
+        const double avgMs = scope.totalSamples > 0 ? scope.totalMs / static_cast<double>(scope.totalSamples) : 0.0;
+        file << (i == 0 ? "\n" : ",\n");
+        file << "    { \"scope\": \"" << scope.name << "\", \"avg\": " << avgMs << ", \"min\": " << scope.minMs << ", \"p99\": " << scope.p99Ms
+             << ", \"samples\": " << scope.totalSamples << " }";
+    }
+    file << (gpuStats.empty() ? "],\n" : "\n  ],\n");
+
+    file << "  \"submits\": { \"total\": " << total.submits << ", \"measured\": " << measured.submits << ", \"perFrame\": " << measured.submits / frames << " },\n";
+    file << "  \"deviceAllocations\": { \"total\": " << totalAllocations << ", \"measured\": " << measuredAllocations << " }\n";
+    file << "}\n";
+
+    return file.good();
+}
+
+// Headless-Lauf mit options.warmupFrames ungemessenen und options.frameCount gemessenen Frames.
+// Gemessen wird die CPU-Zeit pro drawFrame, inklusive Warten auf den Fence.
+template<typename F>
+void runBenchmark(std::string_view name, VkDevice device, const HeadlessOptions& options, GpuProfiler& gpuProfiler, const MemoryTypeSelector& memoryTypes, F&& drawFrame) {
+
+    for (uint32_t frame = 0; frame < options.warmupFrames; frame++) {
+        drawFrame();
+    }
+
+    vkDeviceWaitIdle(device);
+    gpuProfiler.flush();
+    gpuProfiler.reset();
+
+    const BenchmarkCounters before = benchmarkCounters;
+    const uint64_t allocationsBefore = memoryTypes.getStats().allocations;
+
+    std::vector<double> cpuFrameMs;
+    cpuFrameMs.reserve(options.frameCount);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t frame = 0; frame < options.frameCount; frame++) {
+        const auto frameStart = std::chrono::steady_clock::now();
+        drawFrame();
+        cpuFrameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    }
+
+    vkDeviceWaitIdle(device);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    gpuProfiler.flush();
+
+    BenchmarkCounters measured {};
+    measured.submits = benchmarkCounters.submits - before.submits;
+
+    const uint64_t totalAllocations = memoryTypes.getStats().allocations;
+
+    const BenchmarkTimings cpuTimings = computeBenchmarkTimings(std::move(cpuFrameMs));
+
+    std::cout << "Benchmark " << name << ": " << options.frameCount << " Frames, CPU avg " << cpuTimings.avgMs << " ms, p99 " << cpuTimings.p99Ms << " ms" << std::endl;
+
+    if (!writeBenchmarkJson(options.benchmarkPath, name, options, seconds, cpuTimings, gpuProfiler.getStats(), benchmarkCounters, measured, totalAllocations, totalAllocations - allocationsBefore)) {
+        std::cerr << "Benchmark-Ergebnis konnte nicht geschrieben werden: " << options.benchmarkPath << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+#endif //BENCHMARK_H
@@ -0,0 +1,258 @@
+#ifndef COMMAND_RECORDER_H
+#define COMMAND_RECORDER_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "DeviceDispatch.h"
+
+struct CommandRecorderStats {
+    uint32_t draws = 0;
+    uint32_t dispatches = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t pipelineBindsSkipped = 0;
+    uint32_t descriptorSetBinds = 0;
+    uint32_t descriptorSetBindsSkipped = 0;
+    uint32_t vertexBufferBinds = 0;
+    uint32_t vertexBufferBindsSkipped = 0;
+    uint32_t indexBufferBinds = 0;
+    uint32_t indexBufferBindsSkipped = 0;
+    uint32_t pushConstants = 0;
+    uint32_t pushConstantsSkipped = 0;
+
+    uint32_t bindsIssued() const;
+    uint32_t bindsSkipped() const;
+};
+
+// Dünne Schicht über vkCmd*: merkt sich den gebundenen Zustand eines Command Buffers
+// und lässt Aufrufe weg, die nichts ändern würden. Aufrufer können dadurch vor jedem
+// Draw einfach alles binden, ohne dafür im Treiber zu bezahlen.
+class CommandRecorder {
+
+    public:
+        static constexpr uint32_t MAX_DESCRIPTOR_SETS = 4;
+        static constexpr uint32_t MAX_VERTEX_BINDINGS = 8;
+        static constexpr uint32_t MAX_PUSH_CONSTANT_SIZE = 128;
+
+    private:
+        // Grafik und Compute haben getrennte Bindungspunkte
+        static constexpr uint32_t BIND_POINT_COUNT = 2;
+
+        struct BoundDescriptorSet {
+            VkPipelineLayout layout;
+            VkDescriptorSet set;
+        };
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+        std::array<VkPipeline, BIND_POINT_COUNT> pipelines {};
+        std::array<std::array<BoundDescriptorSet, MAX_DESCRIPTOR_SETS>, BIND_POINT_COUNT> descriptorSets {};
+
+        std::array<VkBuffer, MAX_VERTEX_BINDINGS> vertexBuffers {};
+        std::array<VkDeviceSize, MAX_VERTEX_BINDINGS> vertexBufferOffsets {};
+
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        VkDeviceSize indexBufferOffset = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+        // Push Constants werden in 4-Byte-Worten verwaltet, Offset und Größe sind laut Spezifikation Vielfache von 4
+        VkPipelineLayout pushConstantLayout = VK_NULL_HANDLE;
+        std::array<uint8_t, MAX_PUSH_CONSTANT_SIZE> pushConstantData {};
+        std::array<VkShaderStageFlags, MAX_PUSH_CONSTANT_SIZE / 4> pushConstantStages {};
+
+        CommandRecorderStats stats {};
+
+    public:
+        void begin(VkCommandBuffer commandBuffer);
+        void invalidate();
+
+        VkCommandBuffer get() const;
+
+        void bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+        void bindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set, VkDescriptorSet descriptorSet);
+        void bindVertexBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset = 0);
+        void bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type);
+        void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data);
+
+        template<typename T>
+        void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, const T& data);
+
+        void draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+        void drawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+        void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+        const CommandRecorderStats& getStats() const;
+
+    private:
+        static uint32_t bindPointIndex(VkPipelineBindPoint bindPoint);
+};
+
+inline uint32_t CommandRecorderStats::bindsIssued() const {
+    return pipelineBinds + descriptorSetBinds + vertexBufferBinds + indexBufferBinds + pushConstants;
+}
+
+inline uint32_t CommandRecorderStats::bindsSkipped() const {
+    return pipelineBindsSkipped + descriptorSetBindsSkipped + vertexBufferBindsSkipped + indexBufferBindsSkipped + pushConstantsSkipped;
+}
+
+inline void CommandRecorder::begin(VkCommandBuffer commandBuffer) {
+    this->commandBuffer = commandBuffer;
+    stats = {};
+    invalidate();
+}
+
+// Muss aufgerufen werden, wenn am Recorder vorbei direkt in den Command Buffer aufgezeichnet wurde.
+inline void CommandRecorder::invalidate() {
+    pipelines.fill(VK_NULL_HANDLE);
+    for (auto& sets : descriptorSets) {
+        sets.fill({ VK_NULL_HANDLE, VK_NULL_HANDLE });
+    }
+    vertexBuffers.fill(VK_NULL_HANDLE);
+    vertexBufferOffsets.fill(0);
+    indexBuffer = VK_NULL_HANDLE;
+    indexBufferOffset = 0;
+    pushConstantLayout = VK_NULL_HANDLE;
+    pushConstantStages.fill(0);
+}
+
+inline VkCommandBuffer CommandRecorder::get() const {
+    return commandBuffer;
+}
+
+inline uint32_t CommandRecorder::bindPointIndex(VkPipelineBindPoint bindPoint) {
+
+    if (bindPoint != VK_PIPELINE_BIND_POINT_GRAPHICS && bindPoint != VK_PIPELINE_BIND_POINT_COMPUTE) {
+        std::cerr << "Bindungspunkt wird vom CommandRecorder nicht unterstützt!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    return bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS ? 0 : 1;
+}
+
+inline void CommandRecorder::bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline) {
+
+    VkPipeline& bound = pipelines[bindPointIndex(bindPoint)];
+
+    if (bound == pipeline) {
+        stats.pipelineBindsSkipped++;
+        return;
+    }
+
+    deviceDispatch.vkCmdBindPipeline(commandBuffer, bindPoint, pipeline);
+    bound = pipeline;
+    stats.pipelineBinds++;
+}
+
+inline void CommandRecorder::bindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set, VkDescriptorSet descriptorSet) {
+
+    auto& sets = descriptorSets[bindPointIndex(bindPoint)];
+
+    if (set < MAX_DESCRIPTOR_SETS && sets[set].layout == layout && sets[set].set == descriptorSet) {
+        stats.descriptorSetBindsSkipped++;
+        return;
+    }
+
+    deviceDispatch.vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, set, 1, &descriptorSet, 0, nullptr);
+    stats.descriptorSetBinds++;
+
+    // Ein Set mit anderem Layout kann alle höheren Sets ungültig machen
+    for (uint32_t i = set; i < MAX_DESCRIPTOR_SETS; i++) {
+        sets[i] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    }
+    if (set < MAX_DESCRIPTOR_SETS) {
+        sets[set] = { layout, descriptorSet };
+    }
+}
+
+inline void CommandRecorder::bindVertexBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset) {
+
+    if (binding < MAX_VERTEX_BINDINGS && vertexBuffers[binding] == buffer && vertexBufferOffsets[binding] == offset) {
+        stats.vertexBufferBindsSkipped++;
+        return;
+    }
+
+    deviceDispatch.vkCmdBindVertexBuffers(commandBuffer, binding, 1, &buffer, &offset);
+    stats.vertexBufferBinds++;
+
+    if (binding < MAX_VERTEX_BINDINGS) {
+        vertexBuffers[binding] = buffer;
+        vertexBufferOffsets[binding] = offset;
+    }
+}
+
+inline void CommandRecorder::bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type) {
+
+    if (indexBuffer == buffer && indexBufferOffset == offset && indexType == type) {
+        stats.indexBufferBindsSkipped++;
+        return;
+    }
+
+    deviceDispatch.vkCmdBindIndexBuffer(commandBuffer, buffer, offset, type);
+    indexBuffer = buffer;
+    indexBufferOffset = offset;
+    indexType = type;
+    stats.indexBufferBinds++;
+}
+
+inline void CommandRecorder::pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data) {
+
+    const bool tracked = offset % 4 == 0 && size % 4 == 0 && offset + size <= MAX_PUSH_CONSTANT_SIZE;
+
+    if (tracked && layout == pushConstantLayout) {
+
+        bool redundant = std::memcmp(pushConstantData.data() + offset, data, size) == 0;
+        for (uint32_t word = offset / 4; redundant && word < (offset + size) / 4; word++) {
+            redundant = pushConstantStages[word] == stages;
+        }
+
+        if (redundant) {
+            stats.pushConstantsSkipped++;
+            return;
+        }
+    }
+
+    deviceDispatch.vkCmdPushConstants(commandBuffer, layout, stages, offset, size, data);
+    stats.pushConstants++;
+
+    if (layout != pushConstantLayout) {
+        pushConstantLayout = layout;
+        pushConstantStages.fill(0);
+    }
+
+    if (tracked) {
+        std::memcpy(pushConstantData.data() + offset, data, size);
+        for (uint32_t word = offset / 4; word < (offset + size) / 4; word++) {
+            pushConstantStages[word] = stages;
+        }
+    }
+}
+
+template<typename T>
+void CommandRecorder::pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, const T& data) {
+    pushConstants(layout, stages, 0, sizeof(T), &data);
+}
+
+inline void CommandRecorder::draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
+    deviceDispatch.vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+    stats.draws++;
+}
+
+inline void CommandRecorder::drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    deviceDispatch.vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    stats.draws++;
+}
+
+inline void CommandRecorder::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+    deviceDispatch.vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+    stats.dispatches++;
+}
+
+inline const CommandRecorderStats& CommandRecorder::getStats() const {
+    return stats;
+}
+
+#endif //COMMAND_RECORDER_H
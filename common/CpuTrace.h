@@ -0,0 +1,228 @@
+#ifndef CPU_TRACE_H
+#define CPU_TRACE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct TraceEvent {
+    const char* name;
+    uint64_t beginNs;
+    uint64_t endNs;
+    uint32_t track;
+};
+
+// Leichtgewichtige CPU-Zeitmessung. Jeder Thread schreibt in einen eigenen Ringpuffer,
+// auf dem heißen Pfad gibt es daher keine Locks. Gesperrt wird nur bei der ersten
+// Messung eines Threads und beim Export. Namen müssen bis zum Export gültig bleiben,
+// String-Literale oder intern() verwenden.
+class CpuTrace {
+
+    public:
+        static constexpr uint32_t RING_SIZE = 16384;
+
+        // Spur 0 ist für GPU-Zeitstempel reserviert, Threads beginnen bei 1
+        static constexpr uint32_t GPU_TRACK = 0;
+
+    private:
+        struct ThreadBuffer {
+            std::array<TraceEvent, RING_SIZE> events;
+            std::atomic<uint64_t> written { 0 };
+            uint32_t track = 0;
+            std::string name;
+        };
+
+        static inline std::atomic<bool> enabled { false };
+        static inline std::mutex registryMutex;
+        static inline std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        static inline std::deque<std::string> names;
+        static inline uint64_t startNs = 0;
+
+    public:
+        static void enable();
+        static bool isEnabled();
+
+        static uint64_t now();
+
+        static void record(const char* name, uint64_t beginNs, uint64_t endNs);
+        static void recordGpu(const char* name, uint64_t beginNs, uint64_t endNs);
+
+        static void setThreadName(std::string_view name);
+        static const char* intern(std::string_view name);
+
+        // Nur aufrufen, wenn keine anderen Threads mehr aufzeichnen.
+        static bool writeChromeTrace(const std::string& path);
+
+    private:
+        static ThreadBuffer& threadBuffer();
+        static void push(ThreadBuffer& buffer, const TraceEvent& event);
+        static void writeEscaped(std::ostream& stream, std::string_view text);
+};
+
+// Misst die Lebensdauer des Objekts als Event im Trace des aktuellen Threads.
+class CpuTraceScope {
+
+    private:
+        const char* name;
+        uint64_t beginNs;
+
+    public:
+        explicit CpuTraceScope(const char* name);
+        ~CpuTraceScope();
+
+        CpuTraceScope(const CpuTraceScope&) = delete;
+        CpuTraceScope& operator=(const CpuTraceScope&) = delete;
+};
+
+inline void CpuTrace::enable() {
+    startNs = now();
+    enabled.store(true, std::memory_order_release);
+}
+
+inline bool CpuTrace::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+inline uint64_t CpuTrace::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline CpuTrace::ThreadBuffer& CpuTrace::threadBuffer() {
+
+    // Puffer gehören der Registry und überleben ihren Thread bis zum Export
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+        buffer->track = static_cast<uint32_t>(buffers.size());
+        buffer->name = "Thread " + std::to_string(buffer->track);
+    }
+
+    return *buffer;
+}
+
+inline void CpuTrace::push(ThreadBuffer& buffer, const TraceEvent& event) {
+
+    // Nur dieser Thread schreibt, der Zähler macht fertige Events für den Export sichtbar
+    const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    buffer.events[index % RING_SIZE] = event;
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+inline void CpuTrace::record(const char* name, uint64_t beginNs, uint64_t endNs) {
+
+    if (!isEnabled()) {
+        return;
+    }
+
+    ThreadBuffer& buffer = threadBuffer();
+    push(buffer, { name, beginNs, endNs, buffer.track });
+}
+
+inline void CpuTrace::recordGpu(const char* name, uint64_t beginNs, uint64_t endNs) {
+
+    if (!isEnabled()) {
+        return;
+    }
+
+    push(threadBuffer(), { name, beginNs, endNs, GPU_TRACK });
+}
+
+inline void CpuTrace::setThreadName(std::string_view name) {
+
+    ThreadBuffer& buffer = threadBuffer();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer.name = std::string(name);
+}
+
+inline const char* CpuTrace::intern(std::string_view name) {
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    for (const std::string& interned : names) {
+        if (interned == name) {
+            return interned.c_str();
+        }
+    }
+
+    // std::deque verschiebt beim Anhängen keine bestehenden Elemente
+    names.emplace_back(name);
+    return names.back().c_str();
+}
+
+inline void CpuTrace::writeEscaped(std::ostream& stream, std::string_view text) {
+
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            stream << ' ';
+        } else {
+            stream << c;
+        }
+    }
+}
+
+inline bool CpuTrace::writeChromeTrace(const std::string& path) {
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_TRACK << ",\"args\":{\"name\":\"GPU\"}}";
+
+    for (const auto& buffer : buffers) {
+
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->track << ",\"args\":{\"name\":\"";
+        writeEscaped(file, buffer->name);
+        file << "\"}}";
+
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const uint64_t first = written > RING_SIZE ? written - RING_SIZE : 0;
+
+        for (uint64_t i = first; i < written; i++) {
+
+            const TraceEvent& event = buffer->events[i % RING_SIZE];
+
+            // Zeitstempel in Mikrosekunden relativ zum Start der Aufzeichnung
+            const double begin = static_cast<double>(static_cast<int64_t>(event.beginNs - startNs)) / 1000.0;
+            const double duration = static_cast<double>(event.endNs - event.beginNs) / 1000.0;
+
+            file << ",\n{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.track << ",\"ts\":" << begin << ",\"dur\":" << duration << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return file.good();
+}
+
+inline CpuTraceScope::CpuTraceScope(const char* name) : name(name), beginNs(CpuTrace::isEnabled() ? CpuTrace::now() : 0) {
+}
+
+inline CpuTraceScope::~CpuTraceScope() {
+    if (beginNs != 0) {
+        CpuTrace::record(name, beginNs, CpuTrace::now());
+    }
+}
+
+#endif //CPU_TRACE_H
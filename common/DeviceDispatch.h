@@ -0,0 +1,159 @@
+#ifndef DEVICE_DISPATCH_H
+#define DEVICE_DISPATCH_H
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Alle Funktionen, die pro Frame oder pro Draw aufgerufen werden. Sie gehen direkt an den
+// Treiber statt über das Trampolin des Loaders, das bei jedem Aufruf erst über das Dispatch-
+// Objekt des Handles springt.
+#define DEVICE_DISPATCH_FUNCTIONS(X) \
+    X(vkQueueSubmit) \
+    X(vkWaitForFences) \
+    X(vkResetFences) \
+    X(vkResetCommandPool) \
+    X(vkResetCommandBuffer) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkGetQueryPoolResults) \
+    X(vkInvalidateMappedMemoryRanges) \
+    X(vkCmdBeginQuery) \
+    X(vkCmdBeginRenderPass) \
+    X(vkCmdBindDescriptorSets) \
+    X(vkCmdBindIndexBuffer) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdBindVertexBuffers) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdCopyImageToBuffer) \
+    X(vkCmdDispatch) \
+    X(vkCmdDraw) \
+    X(vkCmdDrawIndexed) \
+    X(vkCmdEndQuery) \
+    X(vkCmdEndRenderPass) \
+    X(vkCmdFillBuffer) \
+    X(vkCmdPipelineBarrier) \
+    X(vkCmdPushConstants) \
+    X(vkCmdResetQueryPool) \
+    X(vkCmdSetViewport) \
+    X(vkCmdWriteTimestamp)
+
+// Nur vorhanden, wenn die Extension am Device aktiviert ist bzw. die API-Version der Instanz reicht.
+#define DEVICE_DISPATCH_OPTIONAL_FUNCTIONS(X) \
+    X(vkAcquireNextImageKHR) \
+    X(vkQueuePresentKHR) \
+    X(vkCmdBeginRenderingKHR) \
+    X(vkCmdEndRenderingKHR) \
+    X(vkCmdPipelineBarrier2KHR) \
+    X(vkCmdDrawIndexedIndirectCount) \
+    X(vkWaitSemaphores) \
+    X(vkGetSemaphoreCounterValue)
+
+// Funktionstabelle eines Devices, wird einmal nach vkCreateDevice über vkGetDeviceProcAddr gefüllt.
+struct DeviceDispatch {
+
+#define DEVICE_DISPATCH_MEMBER(name) PFN_##name name = nullptr;
+    DEVICE_DISPATCH_FUNCTIONS(DEVICE_DISPATCH_MEMBER)
+    DEVICE_DISPATCH_OPTIONAL_FUNCTIONS(DEVICE_DISPATCH_MEMBER)
+#undef DEVICE_DISPATCH_MEMBER
+
+    void load(VkDevice device);
+};
+
+inline DeviceDispatch deviceDispatch;
+
+inline void DeviceDispatch::load(VkDevice device) {
+
+#define DEVICE_DISPATCH_LOAD(name) \
+    name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name)); \
+    if (name == nullptr) { \
+        std::cerr << "Device-Funktion " << #name << " konnte nicht geladen werden!" << std::endl; \
+        std::exit(EXIT_FAILURE); \
+    }
+    DEVICE_DISPATCH_FUNCTIONS(DEVICE_DISPATCH_LOAD)
+#undef DEVICE_DISPATCH_LOAD
+
+#define DEVICE_DISPATCH_LOAD_OPTIONAL(name) \
+    name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name));
+    DEVICE_DISPATCH_OPTIONAL_FUNCTIONS(DEVICE_DISPATCH_LOAD_OPTIONAL)
+#undef DEVICE_DISPATCH_LOAD_OPTIONAL
+
+    // Ab 1.3 gibt es die Funktionen auch ohne Extension, dann nur unter dem Core-Namen
+#define DEVICE_DISPATCH_LOAD_CORE(name, core) \
+    if (name == nullptr) { \
+        name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, core)); \
+    }
+    DEVICE_DISPATCH_LOAD_CORE(vkCmdBeginRenderingKHR, "vkCmdBeginRendering")
+    DEVICE_DISPATCH_LOAD_CORE(vkCmdEndRenderingKHR, "vkCmdEndRendering")
+    DEVICE_DISPATCH_LOAD_CORE(vkCmdPipelineBarrier2KHR, "vkCmdPipelineBarrier2")
+#undef DEVICE_DISPATCH_LOAD_CORE
+}
+
+struct DispatchOverhead {
+    double lookupNs = 0.0;
+    double loaderNs = 0.0;
+    double directNs = 0.0;
+};
+
+// Misst die Kosten pro Aufruf von vkCmdSetViewport auf drei Wegen: mit vkGetInstanceProcAddr
+// vor jedem Aufruf, über das exportierte Symbol des Loaders und über die Tabelle.
+// Ohne Validation Layer messen, sonst dominieren deren Prüfungen.
+inline DispatchOverhead measureDispatchOverhead(VkInstance instance, VkDevice device, VkCommandPool commandPool, uint32_t calls) {
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo {};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.pNext = nullptr;
+    commandBufferAllocateInfo.commandPool = commandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo {};
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    const VkViewport viewport { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+
+    // Jeder Weg bekommt einen frischen Command Buffer, damit alle gleich viel Speicher anfordern müssen
+    const auto measure = [&](auto&& call) {
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &commandBuffer) != VK_SUCCESS) {
+            std::cerr << "CommandBuffer konnte nicht erstellt werden" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < calls; i++) {
+            call(commandBuffer);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        vkEndCommandBuffer(commandBuffer);
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(calls);
+    };
+
+    DispatchOverhead overhead {};
+
+    overhead.lookupNs = measure([&](VkCommandBuffer commandBuffer) {
+        auto func = reinterpret_cast<PFN_vkCmdSetViewport>(vkGetInstanceProcAddr(instance, "vkCmdSetViewport"));
+        func(commandBuffer, 0, 1, &viewport);
+    });
+
+    overhead.loaderNs = measure([&](VkCommandBuffer commandBuffer) {
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    });
+
+    overhead.directNs = measure([&](VkCommandBuffer commandBuffer) {
+        deviceDispatch.vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    });
+
+    return overhead;
+}
+
+#endif //DEVICE_DISPATCH_H
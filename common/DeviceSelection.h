@@ -0,0 +1,353 @@
+#ifndef DEVICE_SELECTION_H
+#define DEVICE_SELECTION_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Wählt statt der ersten die am höchsten bewertete GPU, Name oder UUID hier erzwingen die Wahl.
+inline constexpr const char* DEVICE_OVERRIDE_VARIABLE = "VULKAN_EXAMPLES_DEVICE";
+
+// Alles, was bei der Auswahl einmal abgefragt wird. Später nur noch hieraus lesen statt
+// vkGetPhysicalDevice* erneut aufzurufen.
+struct DeviceCapabilities {
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+
+    VkPhysicalDeviceProperties properties {};
+    VkPhysicalDeviceFeatures features {};
+    VkPhysicalDeviceMemoryProperties memoryProperties {};
+
+    // Nur ab Vulkan 1.2 auf dem Gerät gefüllt
+    VkPhysicalDeviceVulkan12Features features12 {};
+
+    // Ab Vulkan 1.3 oder mit VK_KHR_dynamic_rendering gefüllt
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures {};
+
+    std::array<uint8_t, VK_UUID_SIZE> deviceUUID {};
+
+    std::vector<VkQueueFamilyProperties> queueFamilies;
+    std::vector<VkExtensionProperties> extensions;
+
+    // Größter DEVICE_LOCAL Heap
+    VkDeviceSize deviceLocalBytes = 0;
+
+    // UINT32_MAX, wenn es keine passende Family gibt. Mit Surface muss die Graphics Family präsentieren können.
+    uint32_t graphicsFamily = UINT32_MAX;
+    uint32_t computeFamily = UINT32_MAX;
+    uint32_t transferFamily = UINT32_MAX;
+
+    bool hasExtension(const char* name) const;
+    std::string uuidString() const;
+};
+
+struct DeviceRequirements {
+    uint32_t apiVersion = VK_API_VERSION_1_0;
+    std::vector<const char*> extensions;
+
+    // Ohne Surface reicht eine Graphics Queue
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+
+    uint32_t minImageDimension2D = 0;
+    uint32_t minPushConstantsSize = 0;
+
+    // Für Features, die sich nicht allgemein ausdrücken lassen
+    std::function<bool(const DeviceCapabilities&)> supports;
+};
+
+inline bool DeviceCapabilities::hasExtension(const char* name) const {
+
+    for (const VkExtensionProperties& extension : extensions) {
+        if (std::strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline std::string DeviceCapabilities::uuidString() const {
+
+    static constexpr char digits[] = "0123456789abcdef";
+
+    std::string uuid;
+    for (uint8_t byte : deviceUUID) {
+        uuid.push_back(digits[byte >> 4]);
+        uuid.push_back(digits[byte & 0xF]);
+    }
+
+    return uuid;
+}
+
+inline DeviceCapabilities probeDeviceCapabilities(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) {
+
+    DeviceCapabilities capabilities {};
+    capabilities.physicalDevice = physicalDevice;
+
+    vkGetPhysicalDeviceProperties(physicalDevice, &capabilities.properties);
+    vkGetPhysicalDeviceFeatures(physicalDevice, &capabilities.features);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &capabilities.memoryProperties);
+
+    const bool vulkan11 = VK_API_VERSION_MINOR(capabilities.properties.apiVersion) >= 1 || VK_API_VERSION_MAJOR(capabilities.properties.apiVersion) > 1;
+    const bool vulkan12 = VK_API_VERSION_MINOR(capabilities.properties.apiVersion) >= 2 || VK_API_VERSION_MAJOR(capabilities.properties.apiVersion) > 1;
+
+    if (vulkan11) {
+        VkPhysicalDeviceIDProperties idProperties {};
+        idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+        idProperties.pNext = nullptr;
+
+        VkPhysicalDeviceProperties2 properties2 {};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &idProperties;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+        std::memcpy(capabilities.deviceUUID.data(), idProperties.deviceUUID, VK_UUID_SIZE);
+    }
+
+    if (vulkan12) {
+        capabilities.features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        capabilities.features12.pNext = nullptr;
+
+        VkPhysicalDeviceFeatures2 features2 {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &capabilities.features12;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+        capabilities.features12.pNext = nullptr;
+    }
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    capabilities.queueFamilies.resize(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, capabilities.queueFamilies.data());
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    capabilities.extensions.resize(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, capabilities.extensions.data());
+
+    const bool vulkan13 = VK_API_VERSION_MINOR(capabilities.properties.apiVersion) >= 3 || VK_API_VERSION_MAJOR(capabilities.properties.apiVersion) > 1;
+
+    // Vor 1.2 bräuchte die Extension weitere Extensions als Voraussetzung
+    if (vulkan13 || (vulkan12 && capabilities.hasExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))) {
+        capabilities.dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+        capabilities.dynamicRenderingFeatures.pNext = nullptr;
+
+        VkPhysicalDeviceFeatures2 features2 {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &capabilities.dynamicRenderingFeatures;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+        capabilities.dynamicRenderingFeatures.pNext = nullptr;
+    }
+
+    for (uint32_t i = 0; i < capabilities.memoryProperties.memoryHeapCount; i++) {
+        const VkMemoryHeap& heap = capabilities.memoryProperties.memoryHeaps[i];
+        if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) && heap.size > capabilities.deviceLocalBytes) {
+            capabilities.deviceLocalBytes = heap.size;
+        }
+    }
+
+    for (uint32_t i = 0; i < queueFamilyCount; i++) {
+
+        const VkQueueFlags flags = capabilities.queueFamilies[i].queueFlags;
+
+        if ((flags & VK_QUEUE_GRAPHICS_BIT) && capabilities.graphicsFamily == UINT32_MAX) {
+            VkBool32 presentSupported = VK_TRUE;
+            if (surface != VK_NULL_HANDLE) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupported);
+            }
+            if (presentSupported) {
+                capabilities.graphicsFamily = i;
+            }
+        }
+
+        // Eigene Families laufen parallel zur Grafik
+        if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && capabilities.computeFamily == UINT32_MAX) {
+            capabilities.computeFamily = i;
+        }
+
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && capabilities.transferFamily == UINT32_MAX) {
+            capabilities.transferFamily = i;
+        }
+    }
+
+    return capabilities;
+}
+
+// Leerer String, wenn alle Anforderungen erfüllt sind, sonst der erste Grund dagegen
+inline std::string checkDeviceRequirements(const DeviceCapabilities& capabilities, const DeviceRequirements& requirements) {
+
+    if (capabilities.properties.apiVersion < requirements.apiVersion) {
+        return "Vulkan-Version zu alt";
+    }
+
+    for (const char* extension : requirements.extensions) {
+        if (!capabilities.hasExtension(extension)) {
+            return std::string("Extension ") + extension + " fehlt";
+        }
+    }
+
+    if (capabilities.graphicsFamily == UINT32_MAX) {
+        return requirements.surface != VK_NULL_HANDLE ? "keine Queue für Grafik und Present" : "keine Queue für Grafik";
+    }
+
+    if (capabilities.properties.limits.maxImageDimension2D < requirements.minImageDimension2D) {
+        return "maxImageDimension2D zu klein";
+    }
+
+    if (capabilities.properties.limits.maxPushConstantsSize < requirements.minPushConstantsSize) {
+        return "maxPushConstantsSize zu klein";
+    }
+
+    if (requirements.supports && !requirements.supports(capabilities)) {
+        return "benötigte Features fehlen";
+    }
+
+    return "";
+}
+
+// Eigene Grafikkarten vor integrierten, Software-Renderer wie lavapipe zuletzt. Innerhalb eines
+// Typs entscheiden Videospeicher, eigene Compute- und Transfer-Queues und Limits.
+inline uint64_t scoreDevice(const DeviceCapabilities& capabilities) {
+
+    uint64_t score = 0;
+
+    switch (capabilities.properties.deviceType) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            score += 100000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            score += 50000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            score += 20000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            break;
+        default:
+            score += 10000;
+            break;
+    }
+
+    // Ein Punkt pro 64 MiB
+    score += capabilities.deviceLocalBytes >> 26;
+
+    if (capabilities.computeFamily != UINT32_MAX) {
+        score += 500;
+    }
+    if (capabilities.transferFamily != UINT32_MAX) {
+        score += 500;
+    }
+
+    score += capabilities.properties.limits.maxImageDimension2D / 1024;
+
+    return score;
+}
+
+// Der Override passt auf die UUID (mit oder ohne Bindestriche) oder auf einen Teil des Namens
+inline bool matchesDeviceOverride(const DeviceCapabilities& capabilities, const std::string& value) {
+
+    std::string uuid;
+    for (char c : value) {
+        if (c != '-') {
+            uuid.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+    }
+
+    if (uuid == capabilities.uuidString()) {
+        return true;
+    }
+
+    return std::string(capabilities.properties.deviceName).find(value) != std::string::npos;
+}
+
+inline const char* deviceTypeName(VkPhysicalDeviceType type) {
+
+    switch (type) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            return "dediziert";
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            return "integriert";
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            return "virtuell";
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            return "CPU";
+        default:
+            return "andere";
+    }
+}
+
+// Fragt alle Geräte einmal ab, verwirft die ungeeigneten und liefert das am höchsten bewertete.
+// Ist DEVICE_OVERRIDE_VARIABLE gesetzt, wird stattdessen das passende Gerät genommen.
+inline DeviceCapabilities selectPhysicalDevice(VkInstance instance, const DeviceRequirements& requirements) {
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+
+    if (deviceCount == 0) {
+        std::cout << "Keine Grafikkarte mit Vulkan-Unterstützung gefunden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+    const char* overrideValue = std::getenv(DEVICE_OVERRIDE_VARIABLE);
+    const bool hasOverride = overrideValue != nullptr && overrideValue[0] != '\0';
+
+    int32_t selected = -1;
+    uint64_t bestScore = 0;
+    std::vector<DeviceCapabilities> candidates;
+
+    for (VkPhysicalDevice physicalDevice : devices) {
+
+        DeviceCapabilities capabilities = probeDeviceCapabilities(physicalDevice, requirements.surface);
+        const std::string rejection = checkDeviceRequirements(capabilities, requirements);
+        const uint64_t score = scoreDevice(capabilities);
+
+        std::cout << "GPU " << capabilities.properties.deviceName << " (" << deviceTypeName(capabilities.properties.deviceType) << ", " << (capabilities.deviceLocalBytes >> 20) << " MiB): ";
+        if (!rejection.empty()) {
+            std::cout << "ungeeignet, " << rejection << std::endl;
+        } else {
+            std::cout << score << " Punkte" << std::endl;
+        }
+
+        if (hasOverride && matchesDeviceOverride(capabilities, overrideValue)) {
+
+            if (!rejection.empty()) {
+                std::cerr << DEVICE_OVERRIDE_VARIABLE << " wählt " << capabilities.properties.deviceName << ", das Gerät ist aber ungeeignet: " << rejection << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            return capabilities;
+        }
+
+        if (rejection.empty() && (selected == -1 || score > bestScore)) {
+            selected = static_cast<int32_t>(candidates.size());
+            bestScore = score;
+        }
+
+        candidates.push_back(std::move(capabilities));
+    }
+
+    if (hasOverride) {
+        std::cout << "Kein Gerät passt zu " << DEVICE_OVERRIDE_VARIABLE << "=" << overrideValue << ", es wird automatisch gewählt" << std::endl;
+    }
+
+    if (selected == -1) {
+        std::cerr << "Keine Grafikkarte erfüllt die Anforderungen!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return candidates[selected];
+}
+
+#endif //DEVICE_SELECTION_H
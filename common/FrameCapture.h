@@ -0,0 +1,434 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Readback.h"
+#include "SpscQueue.h"
+
+enum class CaptureFormat {
+    Raw,
+    Qoi,
+    Y4m
+};
+
+struct CaptureOptions {
+    std::string path;
+    CaptureFormat format = CaptureFormat::Qoi;
+    uint32_t queueSize = 8;
+    uint32_t frameRate = 60;
+
+    bool isEnabled() const {
+        return !path.empty();
+    }
+};
+
+// --capture <pfad> nimmt jedes Frame auf, --capture-format raw|qoi|y4m wählt das Format,
+// --capture-queue N begrenzt die Anzahl gepufferter Frames, --capture-fps N steht im Y4M-Header.
+// raw und y4m schreiben einen Stream nach <pfad>, qoi eine Datei pro Frame nach <pfad>_000000.qoi.
+inline CaptureOptions parseCaptureOptions(int argc, char* argv[]) {
+
+    CaptureOptions options {};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--capture" && i + 1 < argc) {
+            options.path = argv[++i];
+        } else if (argument == "--capture-format" && i + 1 < argc) {
+            const std::string format = argv[++i];
+            if (format == "raw") {
+                options.format = CaptureFormat::Raw;
+            } else if (format == "qoi") {
+                options.format = CaptureFormat::Qoi;
+            } else if (format == "y4m") {
+                options.format = CaptureFormat::Y4m;
+            } else {
+                std::cerr << "Unbekanntes Aufnahmeformat: " << format << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        } else if (argument == "--capture-queue" && i + 1 < argc) {
+            options.queueSize = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--capture-fps" && i + 1 < argc) {
+            options.frameRate = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    return options;
+}
+
+// Schreibt zurückgelesene Frames in einem eigenen Thread auf die Platte. Es gibt eine feste
+// Anzahl Puffer, die zwischen Hauptthread und Writer über zwei SPSC-Warteschlangen kreisen.
+// Ist kein Puffer frei, weil die Platte nicht hinterherkommt, wird das Frame verworfen und
+// gezählt, drawFrame wartet nie auf den Writer.
+class FrameCapture {
+
+    private:
+        struct CapturedFrame {
+            uint32_t buffer = 0;
+            uint64_t frameNumber = 0;
+        };
+
+        CaptureOptions options;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool bgra = false;
+
+        std::vector<std::vector<uint8_t>> buffers;
+        std::unique_ptr<SpscQueue<CapturedFrame>> capturedFrames;
+        std::unique_ptr<SpscQueue<uint32_t>> freeBuffers;
+
+        std::atomic<bool> running { false };
+        std::atomic<uint32_t> signal { 0 };
+        std::thread writer;
+
+        // Gehört dem Hauptthread
+        uint64_t pushedFrames = 0;
+        uint64_t droppedFrames = 0;
+
+        // Gehört dem Writer
+        std::ofstream stream;
+        std::vector<uint8_t> encoded;
+        uint64_t writtenFrames = 0;
+        uint64_t writtenBytes = 0;
+        bool writeFailed = false;
+
+    public:
+        FrameCapture() = default;
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        void start(const CaptureOptions& options, uint32_t width, uint32_t height, VkFormat format);
+
+        // Vom Hauptthread aus dem Readback-Callback aufrufen.
+        void push(const ReadbackFrame& frame);
+
+        // Schreibt alle bereits angenommenen Frames und beendet den Writer.
+        void stop();
+
+        bool isRunning() const;
+        uint64_t getDroppedFrames() const;
+
+    private:
+        void writerLoop();
+        void writeFrame(std::vector<uint8_t>& pixels, uint64_t frameNumber);
+        void writeY4m(const std::vector<uint8_t>& pixels);
+        void encodeQoi(const std::vector<uint8_t>& pixels);
+};
+
+inline void FrameCapture::start(const CaptureOptions& options, uint32_t width, uint32_t height, VkFormat format) {
+
+    this->options = options;
+    this->width = width;
+    this->height = height;
+    bgra = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+
+    const uint32_t bufferCount = std::max(options.queueSize, 1u);
+
+    buffers.assign(bufferCount, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4));
+    capturedFrames = std::make_unique<SpscQueue<CapturedFrame>>(bufferCount);
+    freeBuffers = std::make_unique<SpscQueue<uint32_t>>(bufferCount);
+
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        freeBuffers->push(i);
+    }
+
+    if (options.format != CaptureFormat::Qoi) {
+
+        stream.open(options.path, std::ios::binary);
+        if (!stream.is_open()) {
+            std::cerr << "Aufnahmedatei konnte nicht geöffnet werden: " << options.path << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (options.format == CaptureFormat::Y4m) {
+            stream << "YUV4MPEG2 W" << width << " H" << height << " F" << options.frameRate << ":1 Ip A1:1 C420jpeg\n";
+        }
+    }
+
+    running.store(true, std::memory_order_release);
+    writer = std::thread(&FrameCapture::writerLoop, this);
+}
+
+inline void FrameCapture::push(const ReadbackFrame& frame) {
+
+    if (!running.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    const std::optional<uint32_t> buffer = freeBuffers->pop();
+    if (!buffer) {
+        droppedFrames++;
+        return;
+    }
+
+    uint8_t* destination = buffers[*buffer].data();
+    const size_t rowSize = static_cast<size_t>(width) * 4;
+
+    for (uint32_t y = 0; y < height; y++) {
+        std::memcpy(destination + y * rowSize, frame.data + static_cast<size_t>(y) * frame.rowPitch, rowSize);
+    }
+
+    // Kann nicht fehlschlagen, es gibt nie mehr belegte Puffer als Plätze in der Warteschlange
+    capturedFrames->push({ *buffer, frame.frameNumber });
+    pushedFrames++;
+
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+}
+
+inline void FrameCapture::stop() {
+
+    if (!running.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    running.store(false, std::memory_order_release);
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+
+    writer.join();
+
+    if (stream.is_open()) {
+        stream.close();
+    }
+
+    std::cout << "Aufnahme: " << writtenFrames << " Frames (" << writtenBytes / (1024 * 1024) << " MiB) geschrieben, " << droppedFrames << " von " << pushedFrames + droppedFrames << " Frames verworfen" << std::endl;
+}
+
+inline bool FrameCapture::isRunning() const {
+    return running.load(std::memory_order_relaxed);
+}
+
+inline uint64_t FrameCapture::getDroppedFrames() const {
+    return droppedFrames;
+}
+
+inline void FrameCapture::writerLoop() {
+
+    for (;;) {
+
+        // Erst den Zähler lesen, dann prüfen, damit kein push() zwischen Prüfen und Warten verloren geht
+        const uint32_t seen = signal.load(std::memory_order_acquire);
+
+        if (const std::optional<CapturedFrame> frame = capturedFrames->pop()) {
+            writeFrame(buffers[frame->buffer], frame->frameNumber);
+            freeBuffers->push(frame->buffer);
+            continue;
+        }
+
+        if (!running.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        signal.wait(seen, std::memory_order_acquire);
+    }
+}
+
+inline void FrameCapture::writeFrame(std::vector<uint8_t>& pixels, uint64_t frameNumber) {
+
+    if (writeFailed) {
+        return;
+    }
+
+    // Alle Formate erwarten RGBA
+    if (bgra) {
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            std::swap(pixels[i], pixels[i + 2]);
+        }
+    }
+
+    switch (options.format) {
+
+        case CaptureFormat::Raw:
+            stream.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+            writtenBytes += pixels.size();
+            break;
+
+        case CaptureFormat::Y4m:
+            writeY4m(pixels);
+            break;
+
+        case CaptureFormat::Qoi: {
+            char suffix[32];
+            std::snprintf(suffix, sizeof(suffix), "_%06llu.qoi", static_cast<unsigned long long>(frameNumber));
+
+            encodeQoi(pixels);
+
+            std::ofstream file(options.path + suffix, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            writtenBytes += encoded.size();
+
+            if (!file.good()) {
+                writeFailed = true;
+            }
+            break;
+        }
+    }
+
+    if (stream.is_open() && !stream.good()) {
+        writeFailed = true;
+    }
+
+    if (writeFailed) {
+        std::cerr << "Aufnahme konnte nicht geschrieben werden, weitere Frames werden ignoriert" << std::endl;
+        return;
+    }
+
+    writtenFrames++;
+}
+
+// YUV 4:2:0 mit voller Reichweite nach BT.601, Chroma als Mittelwert über 2x2 Pixel.
+inline void FrameCapture::writeY4m(const std::vector<uint8_t>& pixels) {
+
+    const uint32_t chromaWidth = (width + 1) / 2;
+    const uint32_t chromaHeight = (height + 1) / 2;
+
+    encoded.resize(static_cast<size_t>(width) * height + 2 * static_cast<size_t>(chromaWidth) * chromaHeight);
+
+    uint8_t* yPlane = encoded.data();
+    uint8_t* uPlane = yPlane + static_cast<size_t>(width) * height;
+    uint8_t* vPlane = uPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            const uint8_t* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+            yPlane[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8);
+        }
+    }
+
+    for (uint32_t cy = 0; cy < chromaHeight; cy++) {
+        for (uint32_t cx = 0; cx < chromaWidth; cx++) {
+
+            int r = 0;
+            int g = 0;
+            int b = 0;
+
+            for (uint32_t dy = 0; dy < 2; dy++) {
+                for (uint32_t dx = 0; dx < 2; dx++) {
+                    const uint32_t x = std::min(cx * 2 + dx, width - 1);
+                    const uint32_t y = std::min(cy * 2 + dy, height - 1);
+                    const uint8_t* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+                    r += pixel[0];
+                    g += pixel[1];
+                    b += pixel[2];
+                }
+            }
+
+            r /= 4;
+            g /= 4;
+            b /= 4;
+
+            uPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+            vPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+        }
+    }
+
+    stream << "FRAME\n";
+    stream.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+    writtenBytes += encoded.size() + 6;
+}
+
+// QOI nach https://qoiformat.org/qoi-specification.pdf, verlustfrei und deutlich schneller als PNG.
+inline void FrameCapture::encodeQoi(const std::vector<uint8_t>& pixels) {
+
+    constexpr uint8_t QOI_OP_INDEX = 0x00;
+    constexpr uint8_t QOI_OP_DIFF = 0x40;
+    constexpr uint8_t QOI_OP_LUMA = 0x80;
+    constexpr uint8_t QOI_OP_RUN = 0xc0;
+    constexpr uint8_t QOI_OP_RGB = 0xfe;
+    constexpr uint8_t QOI_OP_RGBA = 0xff;
+
+    encoded.clear();
+    encoded.reserve(14 + pixels.size() + pixels.size() / 4 + 8);
+
+    const auto writeU32 = [this](uint32_t value) {
+        encoded.push_back(static_cast<uint8_t>(value >> 24));
+        encoded.push_back(static_cast<uint8_t>(value >> 16));
+        encoded.push_back(static_cast<uint8_t>(value >> 8));
+        encoded.push_back(static_cast<uint8_t>(value));
+    };
+
+    encoded.insert(encoded.end(), { 'q', 'o', 'i', 'f' });
+    writeU32(width);
+    writeU32(height);
+    encoded.push_back(4);
+    encoded.push_back(0);
+
+    std::array<std::array<uint8_t, 4>, 64> index {};
+    std::array<uint8_t, 4> previous = { 0, 0, 0, 255 };
+    uint32_t run = 0;
+
+    const size_t pixelCount = pixels.size() / 4;
+
+    for (size_t i = 0; i < pixelCount; i++) {
+
+        const std::array<uint8_t, 4> pixel = { pixels[i * 4], pixels[i * 4 + 1], pixels[i * 4 + 2], pixels[i * 4 + 3] };
+
+        if (pixel == previous) {
+            run++;
+            if (run == 62 || i == pixelCount - 1) {
+                encoded.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run > 0) {
+            encoded.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+            run = 0;
+        }
+
+        const uint32_t hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+
+        if (index[hash] == pixel) {
+            encoded.push_back(static_cast<uint8_t>(QOI_OP_INDEX | hash));
+        } else {
+            index[hash] = pixel;
+
+            if (pixel[3] == previous[3]) {
+
+                const int8_t dr = static_cast<int8_t>(pixel[0] - previous[0]);
+                const int8_t dg = static_cast<int8_t>(pixel[1] - previous[1]);
+                const int8_t db = static_cast<int8_t>(pixel[2] - previous[2]);
+                const int8_t drdg = static_cast<int8_t>(dr - dg);
+                const int8_t dbdg = static_cast<int8_t>(db - dg);
+
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    encoded.push_back(static_cast<uint8_t>(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                } else if (dg >= -32 && dg <= 31 && drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7) {
+                    encoded.push_back(static_cast<uint8_t>(QOI_OP_LUMA | (dg + 32)));
+                    encoded.push_back(static_cast<uint8_t>((drdg + 8) << 4 | (dbdg + 8)));
+                } else {
+                    encoded.push_back(QOI_OP_RGB);
+                    encoded.push_back(pixel[0]);
+                    encoded.push_back(pixel[1]);
+                    encoded.push_back(pixel[2]);
+                }
+            } else {
+                encoded.push_back(QOI_OP_RGBA);
+                encoded.insert(encoded.end(), pixel.begin(), pixel.end());
+            }
+        }
+
+        previous = pixel;
+    }
+
+    encoded.insert(encoded.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+}
+
+#endif //FRAME_CAPTURE_H
@@ -0,0 +1,209 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DeviceDispatch.h"
+
+struct FramePacerOptions {
+    bool enabled = false;
+    double targetLatencyMs = 0.0;
+};
+
+// --frame-pacing verzögert das Abtasten der Eingaben, --latency-target MS legt die
+// gewünschte Latenz fest (0 = so gering wie möglich, ohne dass die GPU leer läuft).
+inline FramePacerOptions parseFramePacerOptions(int argc, char* argv[]) {
+
+    FramePacerOptions options {};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--frame-pacing") {
+            options.enabled = true;
+        } else if (argument == "--latency-target" && i + 1 < argc) {
+            options.enabled = true;
+            options.targetLatencyMs = std::strtod(argv[++i], nullptr);
+        }
+    }
+
+    return options;
+}
+
+struct FramePacerStats {
+    double avgLatencyMs = 0.0;
+    double p99LatencyMs = 0.0;
+    double avgSleepMs = 0.0;
+    double avgCpuMs = 0.0;
+    uint32_t samples = 0;
+};
+
+// Begrenzt, wie weit die CPU der GPU vorausläuft. Statt direkt nach dem Fence die Eingaben
+// abzutasten, wird so lange geschlafen, bis der Frame gerade noch rechtzeitig fertig wird,
+// bevor die GPU mit dem vorherigen Frame durch ist. Grundlage sind die gemessene GPU-Zeit
+// pro Frame und die gleitend gemittelte CPU-Zeit vom Abtasten bis zum Submit.
+// Die Latenz wird auch ohne Pacing gemessen, vom Abtasten bis zum beobachteten Fence.
+// Da der Fence erst beim nächsten Durchlauf geprüft wird, ist sie eine obere Schranke.
+class FramePacer {
+
+    public:
+        static constexpr uint32_t HISTORY_SIZE = 256;
+
+        // Reserve für Ungenauigkeiten beim Schlafen und Schwankungen der CPU-Zeit
+        static constexpr double SAFETY_MARGIN_MS = 0.5;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        bool enabled = false;
+        double targetLatencyMs = 0.0;
+
+        std::vector<Clock::time_point> sampleTimes;
+        std::vector<bool> sampled;
+        Clock::time_point lastSubmitTime {};
+
+        double cpuMs = 0.0;
+
+        std::vector<double> latencies;
+        uint32_t next = 0;
+        double totalSleepMs = 0.0;
+        double totalCpuMs = 0.0;
+        uint64_t frames = 0;
+
+    public:
+        void create(const FramePacerOptions& options, uint32_t framesInFlight);
+
+        bool isEnabled() const;
+
+        // Ersetzt das Warten auf den Fence von frameIndex, direkt danach werden die Eingaben abgetastet.
+        void waitForFrame(VkDevice device, VkFence fence, uint32_t frameIndex, double gpuFrameMs);
+
+        // Direkt nach vkQueueSubmit des Frames aufrufen.
+        void frameSubmitted(uint32_t frameIndex);
+
+        FramePacerStats getStats() const;
+
+    private:
+        static void sleepUntil(Clock::time_point time);
+};
+
+inline void FramePacer::create(const FramePacerOptions& options, uint32_t framesInFlight) {
+
+    enabled = options.enabled;
+    targetLatencyMs = options.targetLatencyMs;
+
+    sampleTimes.resize(framesInFlight);
+    sampled.assign(framesInFlight, false);
+    latencies.reserve(HISTORY_SIZE);
+}
+
+inline bool FramePacer::isEnabled() const {
+    return enabled;
+}
+
+inline void FramePacer::sleepUntil(Clock::time_point time) {
+
+    // Schlafen ist auf vielen Systemen nur auf etwa eine Millisekunde genau, den Rest aktiv warten
+    const auto coarse = time - std::chrono::milliseconds(1);
+    if (Clock::now() < coarse) {
+        std::this_thread::sleep_until(coarse);
+    }
+
+    while (Clock::now() < time) {
+        std::this_thread::yield();
+    }
+}
+
+inline void FramePacer::waitForFrame(VkDevice device, VkFence fence, uint32_t frameIndex, double gpuFrameMs) {
+
+    deviceDispatch.vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+    const Clock::time_point completed = Clock::now();
+
+    if (sampled[frameIndex]) {
+
+        const double latencyMs = std::chrono::duration<double, std::milli>(completed - sampleTimes[frameIndex]).count();
+
+        if (latencies.size() < HISTORY_SIZE) {
+            latencies.push_back(latencyMs);
+        } else {
+            latencies[next] = latencyMs;
+        }
+        next = (next + 1) % HISTORY_SIZE;
+    }
+
+    if (enabled && gpuFrameMs > 0.0) {
+
+        const auto toDuration = [](double milliseconds) {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(milliseconds));
+        };
+
+        // Der zuletzt abgeschickte Frame beginnt auf der GPU frühestens jetzt, der Fence dieses Slots ist ja gerade signalisiert
+        const Clock::time_point previousFinish = std::max(lastSubmitTime, completed) + toDuration(gpuFrameMs);
+
+        // Später darf nicht begonnen werden, sonst läuft die GPU leer
+        const Clock::time_point latestStart = previousFinish - toDuration(cpuMs + SAFETY_MARGIN_MS);
+
+        // Frühester Start, bei dem der neue Frame die gewünschte Latenz gerade noch einhält
+        const Clock::time_point targetStart = previousFinish + toDuration(gpuFrameMs - targetLatencyMs);
+
+        const Clock::time_point start = std::min(targetStart, latestStart);
+
+        if (start > completed) {
+            sleepUntil(start);
+            totalSleepMs += std::chrono::duration<double, std::milli>(Clock::now() - completed).count();
+        }
+    }
+
+    sampleTimes[frameIndex] = Clock::now();
+    sampled[frameIndex] = true;
+}
+
+inline void FramePacer::frameSubmitted(uint32_t frameIndex) {
+
+    lastSubmitTime = Clock::now();
+
+    const double frameCpuMs = std::chrono::duration<double, std::milli>(lastSubmitTime - sampleTimes[frameIndex]).count();
+
+    // Gleitender Mittelwert, damit einzelne Ausreißer das Pacing nicht aus dem Tritt bringen
+    cpuMs = frames == 0 ? frameCpuMs : cpuMs * 0.9 + frameCpuMs * 0.1;
+
+    totalCpuMs += frameCpuMs;
+    frames++;
+}
+
+inline FramePacerStats FramePacer::getStats() const {
+
+    FramePacerStats stats {};
+    stats.samples = static_cast<uint32_t>(latencies.size());
+
+    if (frames > 0) {
+        stats.avgSleepMs = totalSleepMs / static_cast<double>(frames);
+        stats.avgCpuMs = totalCpuMs / static_cast<double>(frames);
+    }
+
+    if (latencies.empty()) {
+        return stats;
+    }
+
+    std::vector<double> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (double latency : sorted) {
+        sum += latency;
+    }
+
+    stats.avgLatencyMs = sum / static_cast<double>(sorted.size());
+    stats.p99LatencyMs = sorted[std::min(sorted.size() - 1, static_cast<size_t>(static_cast<double>(sorted.size()) * 0.99))];
+
+    return stats;
+}
+
+#endif //FRAME_PACER_H
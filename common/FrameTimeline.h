@@ -0,0 +1,152 @@
+#ifndef FRAME_TIMELINE_H
+#define FRAME_TIMELINE_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "DeviceDispatch.h"
+
+// Ein einzelner Timeline Semaphore (Vulkan 1.2) verfolgt den Fortschritt der GPU.
+// Jeder Submit signalisiert den nächsten Wert, statt eines Fences pro Frame merkt sich
+// jeder Frame-Slot nur den Wert seines letzten Submits. Uploads, Readbacks und Compute
+// können so ohne zusätzliche Fences gegen beliebige frühere Submits geordnet werden.
+// Setzt voraus, dass das Feature timelineSemaphore am Device aktiviert ist.
+class FrameTimeline {
+
+    private:
+        VkDevice device = VK_NULL_HANDLE;
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+
+        uint64_t lastValue = 0;
+        uint64_t completedValue = 0;
+        std::vector<uint64_t> slotValues;
+
+        uint64_t frameSubmits = 0;
+        uint64_t hostWaits = 0;
+
+    public:
+        void create(VkDevice device, uint32_t framesInFlight);
+        void destroy();
+
+        VkSemaphore getSemaphore() const;
+
+        // Reserviert den Wert, den der nächste Submit signalisieren soll.
+        uint64_t nextValue();
+
+        // Der nächste Submit von frameIndex signalisiert den zurückgegebenen Wert.
+        uint64_t beginFrame(uint32_t frameIndex);
+
+        // Wartet auf dem Host, bis die GPU value erreicht hat. Bereits erreichte Werte kosten keinen Aufruf.
+        void wait(uint64_t value);
+
+        // Wartet, bis der letzte Submit von frameIndex fertig ist und seine Ressourcen wieder frei sind.
+        void waitForFrame(uint32_t frameIndex);
+
+        bool isCompleted(uint64_t value);
+
+        // Alle signalisierten Werte, auch die von Uploads über nextValue()
+        uint64_t getLastValue() const;
+        // Nur die über beginFrame() reservierten Werte
+        uint64_t getFrameSubmits() const;
+        uint64_t getHostWaits() const;
+};
+
+inline void FrameTimeline::create(VkDevice device, uint32_t framesInFlight) {
+
+    this->device = device;
+
+    VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo {};
+    semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    semaphoreTypeCreateInfo.pNext = nullptr;
+    semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    semaphoreTypeCreateInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+
+    if (vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS) {
+        std::cerr << "Timeline Semaphore konnte nicht erstellt werden!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Wert 0 ist von Anfang an erreicht, unbenutzte Slots warten also nie
+    slotValues.assign(framesInFlight, 0);
+}
+
+inline void FrameTimeline::destroy() {
+
+    if (semaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device, semaphore, nullptr);
+        semaphore = VK_NULL_HANDLE;
+    }
+}
+
+inline VkSemaphore FrameTimeline::getSemaphore() const {
+    return semaphore;
+}
+
+inline uint64_t FrameTimeline::nextValue() {
+    return ++lastValue;
+}
+
+inline uint64_t FrameTimeline::beginFrame(uint32_t frameIndex) {
+
+    slotValues[frameIndex] = nextValue();
+    frameSubmits++;
+    return slotValues[frameIndex];
+}
+
+inline bool FrameTimeline::isCompleted(uint64_t value) {
+
+    if (value <= completedValue) {
+        return true;
+    }
+
+    deviceDispatch.vkGetSemaphoreCounterValue(device, semaphore, &completedValue);
+    return value <= completedValue;
+}
+
+inline void FrameTimeline::wait(uint64_t value) {
+
+    if (isCompleted(value)) {
+        return;
+    }
+
+    VkSemaphoreWaitInfo semaphoreWaitInfo {};
+    semaphoreWaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    semaphoreWaitInfo.pNext = nullptr;
+    semaphoreWaitInfo.flags = 0;
+    semaphoreWaitInfo.semaphoreCount = 1;
+    semaphoreWaitInfo.pSemaphores = &semaphore;
+    semaphoreWaitInfo.pValues = &value;
+
+    if (deviceDispatch.vkWaitSemaphores(device, &semaphoreWaitInfo, UINT64_MAX) != VK_SUCCESS) {
+        std::cerr << "Warten auf den Timeline Semaphore fehlgeschlagen!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    completedValue = value;
+    hostWaits++;
+}
+
+inline void FrameTimeline::waitForFrame(uint32_t frameIndex) {
+    wait(slotValues[frameIndex]);
+}
+
+inline uint64_t FrameTimeline::getLastValue() const {
+    return lastValue;
+}
+
+inline uint64_t FrameTimeline::getFrameSubmits() const {
+    return frameSubmits;
+}
+
+inline uint64_t FrameTimeline::getHostWaits() const {
+    return hostWaits;
+}
+
+#endif //FRAME_TIMELINE_H
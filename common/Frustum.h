@@ -0,0 +1,288 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "Matrix.h"
+
+struct AABB {
+    std::array<float, 3> min;
+    std::array<float, 3> max;
+};
+
+struct BoundingSphere {
+    std::array<float, 3> center;
+    float radius;
+};
+
+struct Bounds {
+    AABB aabb;
+    BoundingSphere sphere;
+};
+
+// Ebenen in der Form ax + by + cz + d >= 0 für Punkte innerhalb des Frustums.
+struct Frustum {
+    std::array<std::array<float, 4>, 6> planes;
+};
+
+struct CullingStats {
+    uint32_t drawsTested = 0;
+    uint32_t drawsCulled = 0;
+};
+
+// Bounding Spheres in SoA-Anordnung, aufgefüllt auf ein Vielfaches von 8,
+// damit der Culling-Durchlauf ohne Resteschleife mit SIMD arbeiten kann.
+class SphereList {
+
+    public:
+        static constexpr size_t LANES = 8;
+
+    private:
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> radii;
+        size_t count = 0;
+
+    public:
+        void clear();
+        void push(const BoundingSphere& sphere);
+        size_t size() const;
+
+        friend void cullSpheres(const Frustum& frustum, const SphereList& spheres, std::vector<uint32_t>& visible, CullingStats& stats);
+};
+
+template<typename V>
+Bounds computeBounds(std::span<const V> vertices) {
+
+    Bounds bounds {};
+
+    if (vertices.empty()) {
+        return bounds;
+    }
+
+    auto position = [](const V& vertex) -> std::array<float, 3> {
+        if constexpr (requires { vertex.position.z; }) {
+            return { vertex.position.x, vertex.position.y, vertex.position.z };
+        } else {
+            return { vertex.position.x, vertex.position.y, 0.0f };
+        }
+    };
+
+    bounds.aabb.min.fill(std::numeric_limits<float>::max());
+    bounds.aabb.max.fill(std::numeric_limits<float>::lowest());
+
+    for (const V& vertex : vertices) {
+        const std::array<float, 3> p = position(vertex);
+        for (int i = 0; i < 3; i++) {
+            bounds.aabb.min[i] = std::min(bounds.aabb.min[i], p[i]);
+            bounds.aabb.max[i] = std::max(bounds.aabb.max[i], p[i]);
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        bounds.sphere.center[i] = (bounds.aabb.min[i] + bounds.aabb.max[i]) * 0.5f;
+    }
+
+    // Der Radius um den AABB-Mittelpunkt ist enger als die halbe Diagonale
+    float radiusSquared = 0.0f;
+    for (const V& vertex : vertices) {
+        const std::array<float, 3> p = position(vertex);
+        const float dx = p[0] - bounds.sphere.center[0];
+        const float dy = p[1] - bounds.sphere.center[1];
+        const float dz = p[2] - bounds.sphere.center[2];
+        radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+    }
+    bounds.sphere.radius = std::sqrt(radiusSquared);
+
+    return bounds;
+}
+
+// Gribb/Hartmann für spaltenweise gespeicherte Matrizen und den Vulkan-Tiefenbereich [0, 1].
+inline Frustum extractFrustum(const Matrix4f& viewProjection) {
+
+    const float* m = viewProjection.data();
+
+    auto row = [m](int r) -> std::array<float, 4> {
+        return { m[0 * 4 + r], m[1 * 4 + r], m[2 * 4 + r], m[3 * 4 + r] };
+    };
+
+    const std::array<float, 4> r0 = row(0);
+    const std::array<float, 4> r1 = row(1);
+    const std::array<float, 4> r2 = row(2);
+    const std::array<float, 4> r3 = row(3);
+
+    Frustum frustum {};
+
+    for (int i = 0; i < 4; i++) {
+        frustum.planes[0][i] = r3[i] + r0[i]; // links
+        frustum.planes[1][i] = r3[i] - r0[i]; // rechts
+        frustum.planes[2][i] = r3[i] + r1[i]; // unten
+        frustum.planes[3][i] = r3[i] - r1[i]; // oben
+        frustum.planes[4][i] = r2[i];         // nah
+        frustum.planes[5][i] = r3[i] - r2[i]; // fern
+    }
+
+    for (auto& plane : frustum.planes) {
+        const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (float& value : plane) {
+                value /= length;
+            }
+        }
+    }
+
+    return frustum;
+}
+
+inline BoundingSphere transformSphere(const BoundingSphere& sphere, const Matrix4f& transform) {
+
+    const float* m = transform.data();
+    const auto& c = sphere.center;
+
+    BoundingSphere result {};
+    for (int r = 0; r < 3; r++) {
+        result.center[r] = m[0 * 4 + r] * c[0] + m[1 * 4 + r] * c[1] + m[2 * 4 + r] * c[2] + m[3 * 4 + r];
+    }
+
+    // Ungleichmäßige Skalierung: die längste Achse bestimmt den Radius
+    float maxScaleSquared = 0.0f;
+    for (int col = 0; col < 3; col++) {
+        const float x = m[col * 4 + 0];
+        const float y = m[col * 4 + 1];
+        const float z = m[col * 4 + 2];
+        maxScaleSquared = std::max(maxScaleSquared, x * x + y * y + z * z);
+    }
+    result.radius = sphere.radius * std::sqrt(maxScaleSquared);
+
+    return result;
+}
+
+inline void SphereList::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radii.clear();
+    count = 0;
+}
+
+inline void SphereList::push(const BoundingSphere& sphere) {
+
+    if (count % LANES == 0) {
+        // Neuer Block: mit Kugeln auffüllen, die garantiert verworfen werden
+        const size_t paddedSize = count + LANES;
+        centerX.resize(paddedSize, 0.0f);
+        centerY.resize(paddedSize, 0.0f);
+        centerZ.resize(paddedSize, 0.0f);
+        radii.resize(paddedSize, -std::numeric_limits<float>::max());
+    }
+
+    centerX[count] = sphere.center[0];
+    centerY[count] = sphere.center[1];
+    centerZ[count] = sphere.center[2];
+    radii[count] = sphere.radius;
+    count++;
+}
+
+inline size_t SphereList::size() const {
+    return count;
+}
+
+// Hängt die Indizes aller sichtbaren Kugeln an visible an.
+inline void cullSpheres(const Frustum& frustum, const SphereList& spheres, std::vector<uint32_t>& visible, CullingStats& stats) {
+
+    const size_t paddedCount = spheres.radii.size();
+
+    const float* xs = spheres.centerX.data();
+    const float* ys = spheres.centerY.data();
+    const float* zs = spheres.centerZ.data();
+    const float* rs = spheres.radii.data();
+
+    const size_t visibleBefore = visible.size();
+
+#if defined(__AVX__)
+    for (size_t base = 0; base < paddedCount; base += 8) {
+
+        const __m256 x = _mm256_loadu_ps(xs + base);
+        const __m256 y = _mm256_loadu_ps(ys + base);
+        const __m256 z = _mm256_loadu_ps(zs + base);
+        const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(rs + base));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (const auto& plane : frustum.planes) {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane[0])), _mm256_set1_ps(plane[3]));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(y, _mm256_set1_ps(plane[1])));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(plane[2])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        for (uint32_t lane = 0; lane < 8; lane++) {
+            if (mask & (1 << lane)) {
+                visible.push_back(static_cast<uint32_t>(base + lane));
+            }
+        }
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    for (size_t base = 0; base < paddedCount; base += 4) {
+
+        const __m128 x = _mm_loadu_ps(xs + base);
+        const __m128 y = _mm_loadu_ps(ys + base);
+        const __m128 z = _mm_loadu_ps(zs + base);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(rs + base));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (const auto& plane : frustum.planes) {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane[0])), _mm_set1_ps(plane[3]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane[1])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane[2])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            if (mask & (1 << lane)) {
+                visible.push_back(static_cast<uint32_t>(base + lane));
+            }
+        }
+    }
+#else
+    for (size_t i = 0; i < paddedCount; i++) {
+
+        bool inside = true;
+
+        for (const auto& plane : frustum.planes) {
+            const float distance = plane[0] * xs[i] + plane[1] * ys[i] + plane[2] * zs[i] + plane[3];
+            if (distance < -rs[i]) {
+                inside = false;
+                break;
+            }
+        }
+
+        if (inside) {
+            visible.push_back(static_cast<uint32_t>(i));
+        }
+    }
+#endif
+
+    const auto visibleCount = static_cast<uint32_t>(visible.size() - visibleBefore);
+
+    stats.drawsTested += static_cast<uint32_t>(spheres.count);
+    stats.drawsCulled += static_cast<uint32_t>(spheres.count) - visibleCount;
+}
+
+#endif //FRUSTUM_H
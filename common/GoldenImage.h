@@ -0,0 +1,224 @@
+#ifndef GOLDEN_IMAGE_H
+#define GOLDEN_IMAGE_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Readback.h"
+
+struct GoldenImageOptions {
+    std::string comparePath;
+    std::string writePath;
+    uint32_t tolerance = 2;
+
+    bool isEnabled() const {
+        return !comparePath.empty() || !writePath.empty();
+    }
+};
+
+// --golden <datei.ppm> vergleicht das letzte Frame mit einem Referenzbild,
+// --write-golden <datei.ppm> schreibt es als neues Referenzbild,
+// --golden-tolerance N erlaubt Abweichungen bis N pro Farbkanal.
+inline GoldenImageOptions parseGoldenImageOptions(int argc, char* argv[]) {
+
+    GoldenImageOptions options {};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--golden" && i + 1 < argc) {
+            options.comparePath = argv[++i];
+        } else if (argument == "--write-golden" && i + 1 < argc) {
+            options.writePath = argv[++i];
+        } else if (argument == "--golden-tolerance" && i + 1 < argc) {
+            options.tolerance = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    return options;
+}
+
+struct ImageComparison {
+    uint32_t maxDifference = 0;
+    uint64_t differingPixels = 0;
+    uint64_t pixelCount = 0;
+};
+
+// Behält das zuletzt zurückgelesene Frame und vergleicht es am Ende mit einem
+// Referenzbild im binären PPM-Format (P6). Pro Frame werden nur die Rohdaten kopiert,
+// nach RGB umgewandelt wird einmal in finish().
+class GoldenImageTest {
+
+    private:
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t rowPitch = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint64_t frameNumber = 0;
+        std::vector<uint8_t> pixels;
+
+    public:
+        void capture(const ReadbackFrame& frame);
+
+        // Gibt EXIT_SUCCESS oder EXIT_FAILURE zurück.
+        int finish(const GoldenImageOptions& options) const;
+
+        static bool writePpm(const std::string& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgb);
+        static bool readPpm(const std::string& path, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgb);
+
+        static ImageComparison compare(const std::vector<uint8_t>& expected, const std::vector<uint8_t>& actual, uint32_t tolerance);
+
+    private:
+        std::vector<uint8_t> toRgb() const;
+};
+
+inline void GoldenImageTest::capture(const ReadbackFrame& frame) {
+
+    width = frame.width;
+    height = frame.height;
+    rowPitch = frame.rowPitch;
+    format = frame.format;
+    frameNumber = frame.frameNumber;
+
+    pixels.resize(static_cast<size_t>(rowPitch) * height);
+    std::memcpy(pixels.data(), frame.data, pixels.size());
+}
+
+inline std::vector<uint8_t> GoldenImageTest::toRgb() const {
+
+    const bool bgra = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+
+    for (uint32_t y = 0; y < height; y++) {
+
+        const uint8_t* source = pixels.data() + static_cast<size_t>(y) * rowPitch;
+        uint8_t* destination = rgb.data() + static_cast<size_t>(y) * width * 3;
+
+        for (uint32_t x = 0; x < width; x++) {
+            destination[x * 3 + 0] = source[x * 4 + (bgra ? 2 : 0)];
+            destination[x * 3 + 1] = source[x * 4 + 1];
+            destination[x * 3 + 2] = source[x * 4 + (bgra ? 0 : 2)];
+        }
+    }
+
+    return rgb;
+}
+
+inline bool GoldenImageTest::writePpm(const std::string& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgb) {
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+
+    return file.good();
+}
+
+inline bool GoldenImageTest::readPpm(const std::string& path, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgb) {
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string magic;
+    uint32_t maxValue = 0;
+    file >> magic >> width >> height >> maxValue;
+
+    if (magic != "P6" || maxValue != 255) {
+        return false;
+    }
+
+    // Genau ein Whitespace trennt den Header von den Pixeldaten
+    file.get();
+
+    rgb.resize(static_cast<size_t>(width) * height * 3);
+    file.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+
+    return file.gcount() == static_cast<std::streamsize>(rgb.size());
+}
+
+inline ImageComparison GoldenImageTest::compare(const std::vector<uint8_t>& expected, const std::vector<uint8_t>& actual, uint32_t tolerance) {
+
+    ImageComparison comparison {};
+    comparison.pixelCount = actual.size() / 3;
+
+    for (size_t pixel = 0; pixel < comparison.pixelCount; pixel++) {
+
+        uint32_t pixelDifference = 0;
+        for (size_t channel = 0; channel < 3; channel++) {
+            const int difference = static_cast<int>(expected[pixel * 3 + channel]) - static_cast<int>(actual[pixel * 3 + channel]);
+            pixelDifference = std::max(pixelDifference, static_cast<uint32_t>(std::abs(difference)));
+        }
+
+        comparison.maxDifference = std::max(comparison.maxDifference, pixelDifference);
+        if (pixelDifference > tolerance) {
+            comparison.differingPixels++;
+        }
+    }
+
+    return comparison;
+}
+
+inline int GoldenImageTest::finish(const GoldenImageOptions& options) const {
+
+    if (pixels.empty()) {
+        std::cerr << "Es wurde kein Frame zurückgelesen!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<uint8_t> rgb = toRgb();
+
+    if (!options.writePath.empty()) {
+        if (!writePpm(options.writePath, width, height, rgb)) {
+            std::cerr << "Referenzbild konnte nicht geschrieben werden: " << options.writePath << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Referenzbild geschrieben: " << options.writePath << " (Frame " << frameNumber << ")" << std::endl;
+    }
+
+    if (options.comparePath.empty()) {
+        return EXIT_SUCCESS;
+    }
+
+    uint32_t expectedWidth = 0;
+    uint32_t expectedHeight = 0;
+    std::vector<uint8_t> expected;
+
+    if (!readPpm(options.comparePath, expectedWidth, expectedHeight, expected)) {
+        std::cerr << "Referenzbild konnte nicht gelesen werden: " << options.comparePath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (expectedWidth != width || expectedHeight != height) {
+        std::cerr << "Referenzbild hat " << expectedWidth << "x" << expectedHeight << " statt " << width << "x" << height << " Pixel" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const ImageComparison comparison = compare(expected, rgb, options.tolerance);
+
+    if (comparison.differingPixels > 0) {
+
+        // Das tatsächliche Bild neben das Referenzbild legen, damit man es ansehen kann
+        const std::string actualPath = options.comparePath + ".actual.ppm";
+        writePpm(actualPath, width, height, rgb);
+
+        std::cerr << "Golden Image Test fehlgeschlagen: " << comparison.differingPixels << " von " << comparison.pixelCount << " Pixeln weichen ab (max " << comparison.maxDifference << "), siehe " << actualPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Golden Image Test bestanden (max Abweichung " << comparison.maxDifference << ")" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+#endif //GOLDEN_IMAGE_H
@@ -0,0 +1,443 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CpuTrace.h"
+#include "DeviceDispatch.h"
+#include "DeviceSelection.h"
+
+struct GpuScopeStats {
+    std::string name;
+    double minMs = 0.0;
+    double avgMs = 0.0;
+    double p99Ms = 0.0;
+    uint32_t samples = 0;
+
+    // Über alle Frames seit create() bzw. reset(), nicht nur über die Historie
+    double totalMs = 0.0;
+    uint64_t totalSamples = 0;
+};
+
+// Zeitmessung auf der GPU mit Timestamp Queries. Jeder Frame in Flight hat einen
+// eigenen Query Pool, der erst ausgelesen wird, wenn der Fence dieses Frames
+// signalisiert hat. Dadurch muss die CPU nie auf Ergebnisse warten.
+// Mit VK_EXT_calibrated_timestamps landen die Scopes zusätzlich im CpuTrace.
+class GpuProfiler {
+
+    public:
+        static constexpr uint32_t MAX_SCOPES_PER_FRAME = 32;
+        static constexpr uint32_t HISTORY_SIZE = 256;
+
+    private:
+        struct ScopeRecord {
+            uint32_t scope;
+            uint32_t beginQuery;
+        };
+
+        struct FrameQueries {
+            VkQueryPool queryPool = VK_NULL_HANDLE;
+            std::vector<ScopeRecord> records;
+            uint32_t queryCount = 0;
+            bool submitted = false;
+        };
+
+        struct ScopeHistory {
+            std::string name;
+            const char* traceName;
+            std::vector<double> samples;
+            uint32_t next = 0;
+            double totalMs = 0.0;
+            uint64_t totalSamples = 0;
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+        bool supported = false;
+        double timestampPeriod = 0.0;
+        uint64_t timestampMask = 0;
+
+        PFN_vkGetCalibratedTimestampsEXT getCalibratedTimestamps = nullptr;
+        bool calibrated = false;
+        uint64_t calibrationTicks = 0;
+        uint64_t calibrationNs = 0;
+
+        std::vector<FrameQueries> frames;
+        std::vector<ScopeHistory> scopes;
+        std::vector<uint64_t> results;
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        uint32_t currentFrame = 0;
+        std::vector<uint32_t> openScopes;
+
+    public:
+        void create(const DeviceCapabilities& capabilities, VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight);
+        void destroy();
+
+        // Setzt voraus, dass VK_EXT_calibrated_timestamps am Device aktiviert ist.
+        bool enableCalibration(VkInstance instance, VkPhysicalDevice physicalDevice);
+
+        bool isSupported() const;
+
+        // Nach dem Warten auf den Fence von frameIndex und vor allen Scopes aufrufen,
+        // außerhalb eines Render Passes.
+        void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+        void beginScope(std::string_view name);
+        void endScope();
+
+        // Nach vkDeviceWaitIdle aufrufen, liest die noch ausstehenden Frames aus.
+        void flush();
+
+        // Verwirft alle bisherigen Messungen, z.B. nach dem Aufwärmen.
+        void reset();
+
+        std::vector<GpuScopeStats> getStats() const;
+
+        // Letzte aufgelöste Messung des Scopes, 0 solange es noch keine gibt.
+        double getLatestMs(std::string_view name) const;
+
+    private:
+        void calibrate();
+        uint64_t toCpuTime(uint64_t ticks) const;
+        void resolve(FrameQueries& frame);
+        uint32_t findScope(std::string_view name);
+};
+
+// Misst den umschlossenen Block als benannten Scope.
+class GpuScope {
+
+    private:
+        GpuProfiler& profiler;
+
+    public:
+        GpuScope(GpuProfiler& profiler, std::string_view name);
+        ~GpuScope();
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+};
+
+inline void GpuProfiler::create(const DeviceCapabilities& capabilities, VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight) {
+
+    this->device = device;
+
+    const VkPhysicalDeviceProperties& properties = capabilities.properties;
+    const uint32_t validBits = capabilities.queueFamilies[queueFamilyIndex].timestampValidBits;
+
+    supported = validBits > 0 && properties.limits.timestampPeriod > 0.0f;
+    if (!supported) {
+        std::cout << "Timestamp Queries werden von dieser Queue nicht unterstützt, GPU-Profiling ist deaktiviert" << std::endl;
+        return;
+    }
+
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+    frames.resize(framesInFlight);
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo {};
+    queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCreateInfo.queryCount = MAX_SCOPES_PER_FRAME * 2;
+
+    for (FrameQueries& frame : frames) {
+        if (vkCreateQueryPool(device, &queryPoolCreateInfo, nullptr, &frame.queryPool) != VK_SUCCESS) {
+            std::cerr << "Query Pool konnte nicht erstellt werden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        frame.records.reserve(MAX_SCOPES_PER_FRAME);
+    }
+
+    results.resize(MAX_SCOPES_PER_FRAME * 2);
+}
+
+inline void GpuProfiler::destroy() {
+
+    for (FrameQueries& frame : frames) {
+        vkDestroyQueryPool(device, frame.queryPool, nullptr);
+    }
+
+    frames.clear();
+}
+
+inline bool GpuProfiler::enableCalibration(VkInstance instance, VkPhysicalDevice physicalDevice) {
+
+    if (!supported) {
+        return false;
+    }
+
+    auto getTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT) vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+    getCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT) vkGetDeviceProcAddr(device, "vkGetCalibratedTimestampsEXT");
+
+    if (getTimeDomains == nullptr || getCalibratedTimestamps == nullptr) {
+        getCalibratedTimestamps = nullptr;
+        return false;
+    }
+
+    uint32_t timeDomainCount = 0;
+    getTimeDomains(physicalDevice, &timeDomainCount, nullptr);
+    std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+    getTimeDomains(physicalDevice, &timeDomainCount, timeDomains.data());
+
+    if (std::find(timeDomains.begin(), timeDomains.end(), VK_TIME_DOMAIN_DEVICE_EXT) == timeDomains.end()) {
+        getCalibratedTimestamps = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+// Nur die GPU-Zeit wird abgefragt und mit der CPU-Uhr eingeklammert. Das funktioniert
+// unabhängig davon, welche CPU-Zeitdomäne der Treiber anbietet, der Fehler ist die Dauer des Aufrufs.
+inline void GpuProfiler::calibrate() {
+
+    if (getCalibratedTimestamps == nullptr || !CpuTrace::isEnabled()) {
+        return;
+    }
+
+    VkCalibratedTimestampInfoEXT calibratedTimestampInfo {};
+    calibratedTimestampInfo.sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    calibratedTimestampInfo.pNext = nullptr;
+    calibratedTimestampInfo.timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+
+    uint64_t ticks = 0;
+    uint64_t maxDeviation = 0;
+
+    const uint64_t before = CpuTrace::now();
+    if (getCalibratedTimestamps(device, 1, &calibratedTimestampInfo, &ticks, &maxDeviation) != VK_SUCCESS) {
+        return;
+    }
+    const uint64_t after = CpuTrace::now();
+
+    calibrationTicks = ticks;
+    calibrationNs = before + (after - before) / 2;
+    calibrated = true;
+}
+
+inline uint64_t GpuProfiler::toCpuTime(uint64_t ticks) const {
+
+    // Vorzeichenrichtige Differenz, auch wenn der Zähler weniger als 64 gültige Bits hat
+    uint64_t difference = (ticks - calibrationTicks) & timestampMask;
+    int64_t signedDifference = static_cast<int64_t>(difference);
+
+    if (timestampMask != UINT64_MAX && difference > timestampMask / 2) {
+        signedDifference = static_cast<int64_t>(difference) - static_cast<int64_t>(timestampMask) - 1;
+    }
+
+    return calibrationNs + static_cast<int64_t>(static_cast<double>(signedDifference) * timestampPeriod);
+}
+
+inline bool GpuProfiler::isSupported() const {
+    return supported;
+}
+
+inline void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+
+    if (!supported) {
+        return;
+    }
+
+    if (!openScopes.empty()) {
+        std::cerr << "GPU Scope wurde im vorherigen Frame nicht beendet!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    this->commandBuffer = commandBuffer;
+    currentFrame = frameIndex;
+
+    FrameQueries& frame = frames[frameIndex];
+
+    if (frame.submitted) {
+        calibrate();
+        resolve(frame);
+    }
+
+    deviceDispatch.vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, MAX_SCOPES_PER_FRAME * 2);
+
+    frame.records.clear();
+    frame.queryCount = 0;
+    frame.submitted = true;
+}
+
+inline void GpuProfiler::beginScope(std::string_view name) {
+
+    if (!supported) {
+        return;
+    }
+
+    FrameQueries& frame = frames[currentFrame];
+
+    if (frame.records.size() >= MAX_SCOPES_PER_FRAME) {
+        std::cerr << "Zu viele GPU Scopes in einem Frame!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    const uint32_t beginQuery = frame.queryCount;
+    frame.queryCount += 2;
+
+    deviceDispatch.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, beginQuery);
+
+    openScopes.push_back(static_cast<uint32_t>(frame.records.size()));
+    frame.records.push_back({ findScope(name), beginQuery });
+}
+
+inline void GpuProfiler::endScope() {
+
+    if (!supported) {
+        return;
+    }
+
+    if (openScopes.empty()) {
+        std::cerr << "endScope ohne passendes beginScope!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    FrameQueries& frame = frames[currentFrame];
+    const ScopeRecord& record = frame.records[openScopes.back()];
+    openScopes.pop_back();
+
+    deviceDispatch.vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, record.beginQuery + 1);
+}
+
+inline void GpuProfiler::flush() {
+
+    if (!supported) {
+        return;
+    }
+
+    calibrate();
+
+    for (FrameQueries& frame : frames) {
+        if (frame.submitted) {
+            resolve(frame);
+            frame.records.clear();
+            frame.queryCount = 0;
+            frame.submitted = false;
+        }
+    }
+}
+
+inline void GpuProfiler::reset() {
+
+    for (ScopeHistory& history : scopes) {
+        history.samples.clear();
+        history.next = 0;
+        history.totalMs = 0.0;
+        history.totalSamples = 0;
+    }
+}
+
+inline void GpuProfiler::resolve(FrameQueries& frame) {
+
+    if (frame.queryCount == 0) {
+        return;
+    }
+
+    // Ohne WAIT_BIT: der Fence ist bereits signalisiert, ansonsten wird der Frame verworfen
+    const VkResult result = deviceDispatch.vkGetQueryPoolResults(device, frame.queryPool, 0, frame.queryCount, frame.queryCount * sizeof(uint64_t), results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return;
+    }
+
+    for (const ScopeRecord& record : frame.records) {
+
+        const uint64_t ticks = (results[record.beginQuery + 1] - results[record.beginQuery]) & timestampMask;
+        const double milliseconds = static_cast<double>(ticks) * timestampPeriod / 1000000.0;
+
+        ScopeHistory& history = scopes[record.scope];
+
+        if (calibrated && CpuTrace::isEnabled()) {
+            CpuTrace::recordGpu(history.traceName, toCpuTime(results[record.beginQuery]), toCpuTime(results[record.beginQuery + 1]));
+        }
+
+        if (history.samples.size() < HISTORY_SIZE) {
+            history.samples.push_back(milliseconds);
+        } else {
+            history.samples[history.next] = milliseconds;
+        }
+        history.next = (history.next + 1) % HISTORY_SIZE;
+
+        history.totalMs += milliseconds;
+        history.totalSamples++;
+    }
+}
+
+inline uint32_t GpuProfiler::findScope(std::string_view name) {
+
+    for (uint32_t i = 0; i < scopes.size(); i++) {
+        if (scopes[i].name == name) {
+            return i;
+        }
+    }
+
+    scopes.push_back({ std::string(name), CpuTrace::intern(name), {}, 0, 0.0, 0 });
+    scopes.back().samples.reserve(HISTORY_SIZE);
+
+    return static_cast<uint32_t>(scopes.size() - 1);
+}
+
+inline std::vector<GpuScopeStats> GpuProfiler::getStats() const {
+
+    std::vector<GpuScopeStats> stats;
+    stats.reserve(scopes.size());
+
+    std::vector<double> sorted;
+
+    for (const ScopeHistory& history : scopes) {
+
+        GpuScopeStats scopeStats {};
+        scopeStats.name = history.name;
+        scopeStats.samples = static_cast<uint32_t>(history.samples.size());
+        scopeStats.totalMs = history.totalMs;
+        scopeStats.totalSamples = history.totalSamples;
+
+        if (!history.samples.empty()) {
+
+            sorted = history.samples;
+            std::sort(sorted.begin(), sorted.end());
+
+            double sum = 0.0;
+            for (double sample : sorted) {
+                sum += sample;
+            }
+
+            const size_t p99Index = std::min(sorted.size() - 1, static_cast<size_t>(static_cast<double>(sorted.size()) * 0.99));
+
+            scopeStats.minMs = sorted.front();
+            scopeStats.avgMs = sum / static_cast<double>(sorted.size());
+            scopeStats.p99Ms = sorted[p99Index];
+        }
+
+        stats.push_back(scopeStats);
+    }
+
+    return stats;
+}
+
+inline double GpuProfiler::getLatestMs(std::string_view name) const {
+
+    for (const ScopeHistory& history : scopes) {
+        if (history.name == name && !history.samples.empty()) {
+            return history.samples[(history.next + HISTORY_SIZE - 1) % HISTORY_SIZE];
+        }
+    }
+
+    return 0.0;
+}
+
+inline GpuScope::GpuScope(GpuProfiler& profiler, std::string_view name) : profiler(profiler) {
+    profiler.beginScope(name);
+}
+
+inline GpuScope::~GpuScope() {
+    profiler.endScope();
+}
+
+#endif //GPU_PROFILER_H
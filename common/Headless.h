@@ -0,0 +1,164 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MemoryTypes.h"
+
+struct HeadlessOptions {
+    bool enabled = false;
+    uint32_t frameCount = 1000;
+    uint32_t warmupFrames = 100;
+    std::string benchmarkPath;
+};
+
+// --headless rendert ohne Fenster, Surface und Swapchain, --frames N legt die Anzahl der Frames fest.
+// --benchmark <datei.json> schließt --headless ein, --warmup N Frames werden davor nicht gemessen.
+inline HeadlessOptions parseHeadlessOptions(int argc, char* argv[]) {
+
+    HeadlessOptions options {};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--headless") {
+            options.enabled = true;
+        } else if (argument == "--frames" && i + 1 < argc) {
+            options.frameCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--warmup" && i + 1 < argc) {
+            options.warmupFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--benchmark" && i + 1 < argc) {
+            options.enabled = true;
+            options.benchmarkPath = argv[++i];
+        }
+    }
+
+    return options;
+}
+
+// Ersatz für die Swapchain im Headless-Betrieb: ein device-local Color Image pro Frame in Flight.
+// Der Frame-Index ist gleichzeitig der Image-Index, nach dem Fence des Frames ist das Image wieder frei.
+class OffscreenTargets {
+
+    public:
+        // Layout am Ende des Frames, bereit zum Zurücklesen statt zur Präsentation
+        static constexpr VkImageLayout FINAL_LAYOUT = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    private:
+        MemoryTypeSelector* memoryTypes = nullptr;
+        std::vector<VkImage> images;
+        std::vector<VkDeviceMemory> memories;
+        std::vector<VkImageView> imageViews;
+
+    public:
+        void create(MemoryTypeSelector& memoryTypes, VkDevice device, VkFormat format, VkExtent2D extent, uint32_t count);
+        void destroy(VkDevice device);
+
+        const std::vector<VkImage>& getImages() const;
+        const std::vector<VkImageView>& getImageViews() const;
+};
+
+inline void OffscreenTargets::create(MemoryTypeSelector& memoryTypes, VkDevice device, VkFormat format, VkExtent2D extent, uint32_t count) {
+
+    this->memoryTypes = &memoryTypes;
+
+    images.resize(count);
+    memories.resize(count);
+    imageViews.resize(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+
+        VkImageCreateInfo imageCreateInfo {};
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format = format;
+        imageCreateInfo.extent = { extent.width, extent.height, 1 };
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageCreateInfo, nullptr, &images[i]) != VK_SUCCESS) {
+            std::cerr << "Offscreen Image konnte nicht erstellt werden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(device, images[i], &memoryRequirements);
+
+        if (memoryTypes.allocate(device, memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, memories[i]) != VK_SUCCESS) {
+            std::cerr << "Memory konnte nicht reserviert werden" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        vkBindImageMemory(device, images[i], memories[i], 0);
+
+        VkImageViewCreateInfo imageViewCreateInfo {};
+        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCreateInfo.image = images[i];
+        imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewCreateInfo.format = format;
+        imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &imageViewCreateInfo, nullptr, &imageViews[i]) != VK_SUCCESS) {
+            std::cerr << "Image View konnte nicht erstellt werden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+}
+
+inline void OffscreenTargets::destroy(VkDevice device) {
+
+    for (size_t i = 0; i < images.size(); i++) {
+        vkDestroyImageView(device, imageViews[i], nullptr);
+        vkDestroyImage(device, images[i], nullptr);
+        memoryTypes->free(device, memories[i]);
+    }
+
+    images.clear();
+    memories.clear();
+    imageViews.clear();
+}
+
+inline const std::vector<VkImage>& OffscreenTargets::getImages() const {
+    return images;
+}
+
+inline const std::vector<VkImageView>& OffscreenTargets::getImageViews() const {
+    return imageViews;
+}
+
+// Rendert eine feste Anzahl Frames ohne Ereignisschleife und gibt den Durchsatz aus.
+template<typename F>
+void runHeadless(VkDevice device, uint32_t frameCount, F&& drawFrame) {
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        drawFrame();
+    }
+
+    vkDeviceWaitIdle(device);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Headless: " << frameCount << " Frames in " << seconds << " s (" << (seconds > 0.0 ? frameCount / seconds : 0.0) << " FPS)" << std::endl;
+}
+
+#endif //HEADLESS_H
@@ -28,6 +28,10 @@ class Matrix {
 
         void translate(T x, T y, T z);
         void scale(T x, T y, T z);
+
+        Matrix<T> operator*(const Matrix<T>& other) const;
+
+        const T* data() const;
 };
 
 using Matrix4f = Matrix<float>;
@@ -142,4 +146,19 @@ void Matrix<T>::scale(T x, T y, T z)
     multiply(sm);
 }
 
+template<typename T>
+Matrix<T> Matrix<T>::operator*(const Matrix<T>& other) const
+{
+    Matrix<T> result = *this;
+    result.multiply(other.mx);
+
+    return result;
+}
+
+template<typename T>
+const T* Matrix<T>::data() const
+{
+    return mx.data();
+}
+
 #endif //MATRIX_H
\ No newline at end of file
@@ -0,0 +1,264 @@
+#ifndef MEMORY_TYPES_H
+#define MEMORY_TYPES_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "DeviceSelection.h"
+
+struct MemoryTypeStats {
+    uint64_t allocations = 0;
+
+    // Allokationen, die wegen Budget oder Out of Memory nicht im besten Memory Type gelandet sind
+    uint64_t fallbacks = 0;
+
+    uint64_t budgetQueries = 0;
+    bool budgetSupported = false;
+};
+
+// Wählt Memory Types aus den bei der Geräteauswahl gespeicherten Properties. required muss erfüllt sein,
+// preferred entscheidet zwischen den passenden Types (z.B. DEVICE_LOCAL für Uploads bei ReBAR oder UMA).
+// Heaps, deren Budget nicht mehr reicht, werden nur genommen, wenn es keinen anderen passenden Type gibt.
+class MemoryTypeSelector {
+
+    public:
+        static bool enableMemoryBudget(const DeviceCapabilities& capabilities, std::vector<const char*>& deviceExtensions);
+
+        void create(VkPhysicalDevice physicalDevice, const VkPhysicalDeviceMemoryProperties& memoryProperties, bool budgetEnabled);
+
+        // UINT32_MAX, wenn kein Type die required Flags hat. excludedTypes ist eine Maske wie typeFilter.
+        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, VkDeviceSize size, bool respectBudget = true, uint32_t excludedTypes = 0) const;
+
+        // Weicht bei VK_ERROR_OUT_OF_DEVICE_MEMORY auf den nächstbesten Type aus
+        VkResult allocate(VkDevice device, const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, VkDeviceMemory& memory);
+        void free(VkDevice device, VkDeviceMemory memory);
+
+        // Flags des Types, in dem memory tatsächlich gelandet ist, z.B. um HOST_COHERENT zu prüfen
+        VkMemoryPropertyFlags getPropertyFlags(VkDeviceMemory memory) const;
+
+        const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const;
+        MemoryTypeStats getStats() const;
+
+    private:
+        // Der Treiber aktualisiert das Budget nicht bei jeder Allokation, dazwischen wird selbst mitgezählt
+        static constexpr uint32_t BUDGET_REFRESH_INTERVAL = 16;
+
+        struct Allocation {
+            uint32_t memoryTypeIndex;
+            uint32_t heapIndex;
+            VkDeviceSize size;
+        };
+
+        void refreshBudget();
+        VkDeviceSize availableBytes(uint32_t heapIndex) const;
+
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkPhysicalDeviceMemoryProperties memoryProperties {};
+        bool budgetEnabled = false;
+
+        std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapBudget {};
+        std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapUsage {};
+        std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> pendingBytes {};
+        uint32_t allocationsSinceRefresh = 0;
+
+        std::unordered_map<VkDeviceMemory, Allocation> allocations;
+        MemoryTypeStats stats {};
+};
+
+inline bool MemoryTypeSelector::enableMemoryBudget(const DeviceCapabilities& capabilities, std::vector<const char*>& deviceExtensions) {
+
+    // vkGetPhysicalDeviceMemoryProperties2 ist erst ab Vulkan 1.1 Core
+    const bool vulkan11 = VK_API_VERSION_MINOR(capabilities.properties.apiVersion) >= 1 || VK_API_VERSION_MAJOR(capabilities.properties.apiVersion) > 1;
+
+    if (!vulkan11 || !capabilities.hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        return false;
+    }
+
+    deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    return true;
+}
+
+inline void MemoryTypeSelector::create(VkPhysicalDevice physicalDevice, const VkPhysicalDeviceMemoryProperties& memoryProperties, bool budgetEnabled) {
+
+    this->physicalDevice = physicalDevice;
+    this->memoryProperties = memoryProperties;
+    this->budgetEnabled = budgetEnabled;
+
+    heapUsage.fill(0);
+    pendingBytes.fill(0);
+    allocations.clear();
+
+    stats = {};
+    stats.budgetSupported = budgetEnabled;
+
+    refreshBudget();
+}
+
+inline void MemoryTypeSelector::refreshBudget() {
+
+    allocationsSinceRefresh = 0;
+
+    // Ohne Extension: 80% des Heaps, den Rest braucht erfahrungsgemäß das System
+    if (!budgetEnabled) {
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+            heapBudget[i] = memoryProperties.memoryHeaps[i].size / 10 * 8;
+        }
+        return;
+    }
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties {};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    budgetProperties.pNext = nullptr;
+
+    VkPhysicalDeviceMemoryProperties2 memoryProperties2 {};
+    memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties2.pNext = &budgetProperties;
+    vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &memoryProperties2);
+    stats.budgetQueries++;
+
+    // heapUsage enthält ab jetzt alle bisherigen Allokationen dieses Prozesses
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        heapBudget[i] = budgetProperties.heapBudget[i];
+        heapUsage[i] = budgetProperties.heapUsage[i];
+        pendingBytes[i] = 0;
+    }
+}
+
+inline VkDeviceSize MemoryTypeSelector::availableBytes(uint32_t heapIndex) const {
+
+    const VkDeviceSize used = heapUsage[heapIndex] + pendingBytes[heapIndex];
+    return used < heapBudget[heapIndex] ? heapBudget[heapIndex] - used : 0;
+}
+
+inline uint32_t MemoryTypeSelector::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, VkDeviceSize size, bool respectBudget, uint32_t excludedTypes) const {
+
+    // Über dem Budget zählt mehr als jedes fehlende preferred Flag
+    constexpr uint32_t OVER_BUDGET_COST = 1000;
+
+    uint32_t bestType = UINT32_MAX;
+    uint32_t bestCost = UINT32_MAX;
+
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+
+        if (!(typeFilter & (1u << i)) || (excludedTypes & (1u << i))) {
+            continue;
+        }
+
+        const VkMemoryType& memoryType = memoryProperties.memoryTypes[i];
+        if ((memoryType.propertyFlags & required) != required) {
+            continue;
+        }
+
+        uint32_t cost = 2 * static_cast<uint32_t>(std::popcount(preferred & ~memoryType.propertyFlags));
+
+        // Host-sichtbarer Speicher, den niemand mappt, belegt auf dedizierten GPUs die kleine BAR
+        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !((required | preferred) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+            cost += 1;
+        }
+
+        if (respectBudget && availableBytes(memoryType.heapIndex) < size) {
+            cost += OVER_BUDGET_COST;
+        }
+
+        // Bei Gleichstand gewinnt der kleinere Index, die Types sind nach Leistung sortiert
+        if (cost < bestCost) {
+            bestType = i;
+            bestCost = cost;
+        }
+    }
+
+    return bestType;
+}
+
+inline VkResult MemoryTypeSelector::allocate(VkDevice device, const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, VkDeviceMemory& memory) {
+
+    if (budgetEnabled && allocationsSinceRefresh >= BUDGET_REFRESH_INTERVAL) {
+        refreshBudget();
+    }
+
+    const uint32_t idealType = findMemoryType(memoryRequirements.memoryTypeBits, required, preferred, memoryRequirements.size, false, 0);
+    uint32_t excludedTypes = 0;
+
+    while (true) {
+
+        const uint32_t memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, required, preferred, memoryRequirements.size, true, excludedTypes);
+        if (memoryTypeIndex == UINT32_MAX) {
+            return excludedTypes == 0 ? VK_ERROR_FEATURE_NOT_PRESENT : VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        VkMemoryAllocateInfo memoryAllocateInfo {};
+        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memoryAllocateInfo.pNext = nullptr;
+        memoryAllocateInfo.allocationSize = memoryRequirements.size;
+        memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+        const VkResult result = vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &memory);
+
+        if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY) {
+            excludedTypes |= 1u << memoryTypeIndex;
+            continue;
+        }
+
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        const uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+        allocations[memory] = { memoryTypeIndex, heapIndex, memoryRequirements.size };
+        pendingBytes[heapIndex] += memoryRequirements.size;
+        allocationsSinceRefresh++;
+
+        stats.allocations++;
+        if (memoryTypeIndex != idealType) {
+            stats.fallbacks++;
+        }
+
+        return VK_SUCCESS;
+    }
+}
+
+inline void MemoryTypeSelector::free(VkDevice device, VkDeviceMemory memory) {
+
+    if (memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    auto it = allocations.find(memory);
+    if (it != allocations.end()) {
+        VkDeviceSize& pending = pendingBytes[it->second.heapIndex];
+        pending -= std::min(pending, it->second.size);
+        allocations.erase(it);
+    }
+
+    // Steckt die Allokation schon in heapUsage, stimmt das Budget erst nach dem nächsten Abfragen wieder
+    if (budgetEnabled) {
+        allocationsSinceRefresh = BUDGET_REFRESH_INTERVAL;
+    }
+
+    vkFreeMemory(device, memory, nullptr);
+}
+
+inline VkMemoryPropertyFlags MemoryTypeSelector::getPropertyFlags(VkDeviceMemory memory) const {
+
+    auto it = allocations.find(memory);
+    if (it == allocations.end()) {
+        return 0;
+    }
+
+    return memoryProperties.memoryTypes[it->second.memoryTypeIndex].propertyFlags;
+}
+
+inline const VkPhysicalDeviceMemoryProperties& MemoryTypeSelector::getMemoryProperties() const {
+    return memoryProperties;
+}
+
+inline MemoryTypeStats MemoryTypeSelector::getStats() const {
+    return stats;
+}
+
+#endif //MEMORY_TYPES_H
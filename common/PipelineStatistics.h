@@ -0,0 +1,262 @@
+#ifndef PIPELINE_STATISTICS_H
+#define PIPELINE_STATISTICS_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DeviceDispatch.h"
+
+struct PipelineStatisticsResult {
+    uint64_t inputAssemblyVertices = 0;
+    uint64_t vertexShaderInvocations = 0;
+    uint64_t clippingInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentShaderInvocations = 0;
+};
+
+struct PipelineStatisticsGroup {
+    std::string name;
+    PipelineStatisticsResult last;
+    PipelineStatisticsResult total;
+    uint64_t frames = 0;
+};
+
+// Pipeline Statistics Queries um Gruppen von Draws. Wie beim GpuProfiler gibt es einen
+// Query Pool pro Frame in Flight, ausgelesen wird erst nach dem Fence des Frames.
+// Ohne das Feature pipelineStatisticsQuery sind alle Aufrufe wirkungslos.
+class PipelineStatistics {
+
+    public:
+        static constexpr uint32_t MAX_GROUPS_PER_FRAME = 16;
+
+        // Reihenfolge der Werte im Ergebnis entspricht der Reihenfolge der Bits
+        static constexpr VkQueryPipelineStatisticFlags STATISTICS =
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+        static constexpr uint32_t STATISTIC_COUNT = 5;
+
+    private:
+        struct FrameQueries {
+            VkQueryPool queryPool = VK_NULL_HANDLE;
+            std::vector<uint32_t> groups;
+            bool submitted = false;
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+        bool enabled = false;
+
+        std::vector<FrameQueries> frames;
+        std::vector<PipelineStatisticsGroup> groups;
+        std::vector<uint64_t> results;
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        uint32_t currentFrame = 0;
+        bool groupOpen = false;
+
+    public:
+        void create(VkDevice device, bool enabled, uint32_t framesInFlight);
+        void destroy();
+
+        bool isEnabled() const;
+
+        // Nach dem Warten auf den Fence von frameIndex aufrufen, außerhalb eines Render Passes.
+        void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+        // Gruppen dürfen nicht verschachtelt werden und müssen im selben Subpass enden.
+        void beginGroup(std::string_view name);
+        void endGroup();
+
+        // Nach vkDeviceWaitIdle aufrufen, liest die noch ausstehenden Frames aus.
+        void flush();
+
+        const std::vector<PipelineStatisticsGroup>& getGroups() const;
+
+    private:
+        void resolve(FrameQueries& frame);
+        uint32_t findGroup(std::string_view name);
+};
+
+inline void PipelineStatistics::create(VkDevice device, bool enabled, uint32_t framesInFlight) {
+
+    this->device = device;
+    this->enabled = enabled;
+
+    if (!enabled) {
+        std::cout << "Pipeline Statistics Queries werden nicht unterstützt und sind deaktiviert" << std::endl;
+        return;
+    }
+
+    frames.resize(framesInFlight);
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo {};
+    queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    queryPoolCreateInfo.queryCount = MAX_GROUPS_PER_FRAME;
+    queryPoolCreateInfo.pipelineStatistics = STATISTICS;
+
+    for (FrameQueries& frame : frames) {
+        if (vkCreateQueryPool(device, &queryPoolCreateInfo, nullptr, &frame.queryPool) != VK_SUCCESS) {
+            std::cerr << "Query Pool konnte nicht erstellt werden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        frame.groups.reserve(MAX_GROUPS_PER_FRAME);
+    }
+
+    results.resize(MAX_GROUPS_PER_FRAME * STATISTIC_COUNT);
+}
+
+inline void PipelineStatistics::destroy() {
+
+    for (FrameQueries& frame : frames) {
+        vkDestroyQueryPool(device, frame.queryPool, nullptr);
+    }
+
+    frames.clear();
+}
+
+inline bool PipelineStatistics::isEnabled() const {
+    return enabled;
+}
+
+inline void PipelineStatistics::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+
+    if (!enabled) {
+        return;
+    }
+
+    this->commandBuffer = commandBuffer;
+    currentFrame = frameIndex;
+
+    FrameQueries& frame = frames[frameIndex];
+
+    if (frame.submitted) {
+        resolve(frame);
+    }
+
+    deviceDispatch.vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, MAX_GROUPS_PER_FRAME);
+
+    frame.groups.clear();
+    frame.submitted = true;
+}
+
+inline void PipelineStatistics::beginGroup(std::string_view name) {
+
+    if (!enabled) {
+        return;
+    }
+
+    FrameQueries& frame = frames[currentFrame];
+
+    if (groupOpen) {
+        std::cerr << "Pipeline Statistics Gruppen können nicht verschachtelt werden!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (frame.groups.size() >= MAX_GROUPS_PER_FRAME) {
+        std::cerr << "Zu viele Pipeline Statistics Gruppen in einem Frame!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    deviceDispatch.vkCmdBeginQuery(commandBuffer, frame.queryPool, static_cast<uint32_t>(frame.groups.size()), 0);
+
+    frame.groups.push_back(findGroup(name));
+    groupOpen = true;
+}
+
+inline void PipelineStatistics::endGroup() {
+
+    if (!enabled) {
+        return;
+    }
+
+    if (!groupOpen) {
+        std::cerr << "endGroup ohne passendes beginGroup!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    FrameQueries& frame = frames[currentFrame];
+
+    deviceDispatch.vkCmdEndQuery(commandBuffer, frame.queryPool, static_cast<uint32_t>(frame.groups.size() - 1));
+    groupOpen = false;
+}
+
+inline void PipelineStatistics::flush() {
+
+    if (!enabled) {
+        return;
+    }
+
+    for (FrameQueries& frame : frames) {
+        if (frame.submitted) {
+            resolve(frame);
+            frame.groups.clear();
+            frame.submitted = false;
+        }
+    }
+}
+
+inline void PipelineStatistics::resolve(FrameQueries& frame) {
+
+    const auto queryCount = static_cast<uint32_t>(frame.groups.size());
+    if (queryCount == 0) {
+        return;
+    }
+
+    const VkDeviceSize stride = STATISTIC_COUNT * sizeof(uint64_t);
+
+    const VkResult result = deviceDispatch.vkGetQueryPoolResults(device, frame.queryPool, 0, queryCount, queryCount * stride, results.data(), stride, VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return;
+    }
+
+    for (uint32_t query = 0; query < queryCount; query++) {
+
+        const uint64_t* values = results.data() + query * STATISTIC_COUNT;
+
+        PipelineStatisticsResult statistics {};
+        statistics.inputAssemblyVertices = values[0];
+        statistics.vertexShaderInvocations = values[1];
+        statistics.clippingInvocations = values[2];
+        statistics.clippingPrimitives = values[3];
+        statistics.fragmentShaderInvocations = values[4];
+
+        PipelineStatisticsGroup& group = groups[frame.groups[query]];
+        group.last = statistics;
+        group.total.inputAssemblyVertices += statistics.inputAssemblyVertices;
+        group.total.vertexShaderInvocations += statistics.vertexShaderInvocations;
+        group.total.clippingInvocations += statistics.clippingInvocations;
+        group.total.clippingPrimitives += statistics.clippingPrimitives;
+        group.total.fragmentShaderInvocations += statistics.fragmentShaderInvocations;
+        group.frames++;
+    }
+}
+
+inline uint32_t PipelineStatistics::findGroup(std::string_view name) {
+
+    for (uint32_t i = 0; i < groups.size(); i++) {
+        if (groups[i].name == name) {
+            return i;
+        }
+    }
+
+    PipelineStatisticsGroup group {};
+    group.name = std::string(name);
+    groups.push_back(group);
+
+    return static_cast<uint32_t>(groups.size() - 1);
+}
+
+inline const std::vector<PipelineStatisticsGroup>& PipelineStatistics::getGroups() const {
+    return groups;
+}
+
+#endif //PIPELINE_STATISTICS_H
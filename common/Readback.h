@@ -0,0 +1,264 @@
+#ifndef READBACK_H
+#define READBACK_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "DeviceDispatch.h"
+#include "MemoryTypes.h"
+
+struct ReadbackFrame {
+    const uint8_t* data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t rowPitch = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint64_t frameNumber = 0;
+};
+
+using ReadbackCallback = std::function<void(const ReadbackFrame&)>;
+
+// Liest ein Color Image am Ende des Frames in einen host-sichtbaren Buffer zurück.
+// Wie bei einem PBO-Ring gibt es einen Buffer pro Frame in Flight. Der Callback wird
+// erst aufgerufen, wenn der Fence des Frames signalisiert hat, der Frame wartet also nie.
+// Die Daten sind nur während des Callbacks gültig. Unterstützt 4 Byte pro Pixel.
+class FrameReadback {
+
+    private:
+        struct Slot {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            const uint8_t* mapped = nullptr;
+            bool coherent = false;
+            uint64_t frameNumber = 0;
+            bool pending = false;
+        };
+
+        MemoryTypeSelector* memoryTypes = nullptr;
+        VkDevice device = VK_NULL_HANDLE;
+        VkExtent2D extent {};
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        bool enabled = false;
+
+        std::vector<Slot> slots;
+        ReadbackCallback callback;
+        uint64_t frameCounter = 0;
+
+    public:
+        void create(MemoryTypeSelector& memoryTypes, VkDevice device, VkExtent2D extent, VkFormat format, uint32_t framesInFlight, ReadbackCallback callback);
+        void destroy();
+
+        bool isEnabled() const;
+
+        // Nach dem Rendern aufzeichnen. Das Image muss mit TRANSFER_SRC erstellt sein,
+        // es liegt in layout vor und wird danach wieder in layout überführt.
+        void record(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImage image, VkImageLayout layout);
+
+        // Nach dem Warten auf den Fence von frameIndex aufrufen.
+        void collect(uint32_t frameIndex);
+
+        // Nach vkDeviceWaitIdle aufrufen, übergibt alle ausstehenden Frames in Reihenfolge.
+        void flush();
+
+    private:
+        void deliver(Slot& slot);
+};
+
+inline void FrameReadback::create(MemoryTypeSelector& memoryTypes, VkDevice device, VkExtent2D extent, VkFormat format, uint32_t framesInFlight, ReadbackCallback callback) {
+
+    switch (format) {
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            break;
+        default:
+            std::cerr << "Format wird für das Zurücklesen nicht unterstützt!" << std::endl;
+            std::exit(EXIT_FAILURE);
+    }
+
+    this->memoryTypes = &memoryTypes;
+    this->device = device;
+    this->extent = extent;
+    this->format = format;
+    this->callback = std::move(callback);
+
+    slots.resize(framesInFlight);
+
+    for (Slot& slot : slots) {
+
+        VkBufferCreateInfo bufferCreateInfo {};
+        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCreateInfo.size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+        bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &slot.buffer) != VK_SUCCESS) {
+            std::cerr << "Readback Buffer konnte nicht erstellt werden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(device, slot.buffer, &memoryRequirements);
+
+        // Gecachter Speicher ist beim Lesen durch die CPU deutlich schneller, braucht aber ein Invalidate
+        if (memoryTypes.allocate(device, memoryRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, slot.memory) != VK_SUCCESS) {
+            std::cerr << "Memory konnte nicht reserviert werden" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        slot.coherent = (memoryTypes.getPropertyFlags(slot.memory) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+        vkBindBufferMemory(device, slot.buffer, slot.memory, 0);
+
+        void* mapped = nullptr;
+        vkMapMemory(device, slot.memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+        slot.mapped = static_cast<const uint8_t*>(mapped);
+    }
+
+    enabled = true;
+}
+
+inline void FrameReadback::destroy() {
+
+    for (Slot& slot : slots) {
+        vkUnmapMemory(device, slot.memory);
+        vkDestroyBuffer(device, slot.buffer, nullptr);
+        memoryTypes->free(device, slot.memory);
+    }
+
+    slots.clear();
+    enabled = false;
+}
+
+inline bool FrameReadback::isEnabled() const {
+    return enabled;
+}
+
+inline void FrameReadback::record(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImage image, VkImageLayout layout) {
+
+    if (!enabled) {
+        return;
+    }
+
+    Slot& slot = slots[frameIndex];
+
+    VkImageMemoryBarrier imageMemoryBarrier {};
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageMemoryBarrier.oldLayout = layout;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image = image;
+    imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
+    imageMemoryBarrier.subresourceRange.levelCount = 1;
+    imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+    imageMemoryBarrier.subresourceRange.layerCount = 1;
+
+    // Auch ohne Layoutwechsel nötig, die Schreibzugriffe des Render Passes müssen sichtbar werden.
+    // Der letzte Übergang davor (Render Graph oder externe Abhängigkeit des Render Passes) endet auf
+    // BOTTOM_OF_PIPE, erst ALL_COMMANDS ordnet die Kopie auch hinter diesen Layoutwechsel.
+    deviceDispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+    VkBufferImageCopy bufferImageCopy {};
+    bufferImageCopy.bufferOffset = 0;
+    bufferImageCopy.bufferRowLength = 0;
+    bufferImageCopy.bufferImageHeight = 0;
+    bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    bufferImageCopy.imageSubresource.mipLevel = 0;
+    bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+    bufferImageCopy.imageSubresource.layerCount = 1;
+    bufferImageCopy.imageOffset = { 0, 0, 0 };
+    bufferImageCopy.imageExtent = { extent.width, extent.height, 1 };
+
+    deviceDispatch.vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &bufferImageCopy);
+
+    if (layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+        imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        imageMemoryBarrier.dstAccessMask = 0;
+        imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageMemoryBarrier.newLayout = layout;
+
+        deviceDispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+    }
+
+    VkBufferMemoryBarrier bufferMemoryBarrier {};
+    bufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferMemoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferMemoryBarrier.buffer = slot.buffer;
+    bufferMemoryBarrier.offset = 0;
+    bufferMemoryBarrier.size = VK_WHOLE_SIZE;
+
+    deviceDispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+
+    slot.frameNumber = frameCounter++;
+    slot.pending = true;
+}
+
+inline void FrameReadback::deliver(Slot& slot) {
+
+    if (!slot.coherent) {
+        VkMappedMemoryRange mappedMemoryRange {};
+        mappedMemoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        mappedMemoryRange.memory = slot.memory;
+        mappedMemoryRange.offset = 0;
+        mappedMemoryRange.size = VK_WHOLE_SIZE;
+
+        deviceDispatch.vkInvalidateMappedMemoryRanges(device, 1, &mappedMemoryRange);
+    }
+
+    ReadbackFrame frame {};
+    frame.data = slot.mapped;
+    frame.width = extent.width;
+    frame.height = extent.height;
+    frame.rowPitch = extent.width * 4;
+    frame.format = format;
+    frame.frameNumber = slot.frameNumber;
+
+    slot.pending = false;
+
+    if (callback) {
+        callback(frame);
+    }
+}
+
+inline void FrameReadback::collect(uint32_t frameIndex) {
+
+    if (!enabled || !slots[frameIndex].pending) {
+        return;
+    }
+
+    deliver(slots[frameIndex]);
+}
+
+inline void FrameReadback::flush() {
+
+    std::vector<Slot*> pending;
+    for (Slot& slot : slots) {
+        if (slot.pending) {
+            pending.push_back(&slot);
+        }
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const Slot* a, const Slot* b) {
+        return a->frameNumber < b->frameNumber;
+    });
+
+    for (Slot* slot : pending) {
+        deliver(*slot);
+    }
+}
+
+#endif //READBACK_H
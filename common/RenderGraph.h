@@ -0,0 +1,1090 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BarrierBatch.h"
+#include "DeviceDispatch.h"
+#include "MemoryTypes.h"
+
+using RenderResource = uint32_t;
+
+enum class ResourceUsage {
+    ColorAttachment,
+    DepthAttachment,
+    Sampled,
+    Storage,
+    TransferSrc,
+    TransferDst
+};
+
+struct TransientImageDesc {
+    VkFormat format;
+    VkExtent2D extent;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+struct RenderGraphStats {
+    uint32_t passes = 0;
+    uint32_t culledPasses = 0;
+    uint32_t barriersPerFrame = 0;
+    uint32_t transientImages = 0;
+    VkDeviceSize transientBytes = 0;
+    VkDeviceSize transientBytesWithoutAliasing = 0;
+
+    // Images, deren Speicher sich mit dem eines anderen Images überschneidet
+    uint32_t aliasedImages = 0;
+
+    // Davon in Lazily Allocated Memory, belegt auf Tile-GPUs nur so viel echten Speicher wie nötig, meist keinen
+    uint32_t lazyImages = 0;
+    VkDeviceSize lazyBytes = 0;
+};
+
+// Frame Graph für die Passes eines Frames. Passes geben an, welche Images sie lesen und
+// schreiben, compile() verwirft Passes, deren Ergebnis nie gelesen wird, plant die
+// minimal nötigen Barrieren und Layout-Übergänge und legt transiente Images, deren
+// Lebenszeiten sich nicht überschneiden, in denselben Speicher. Images, die nur innerhalb
+// eines einzigen Passes als Attachment dienen, bekommen VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+// und landen, wo vorhanden, in Lazily Allocated Memory. execute() zeichnet
+// den kompilierten Graphen dann jeden Frame ohne weitere Analyse auf.
+// Passes mit Attachments werden mit Dynamic Rendering begonnen, das am Device aktiviert
+// sein muss. Importierte Images (z.B. Swapchain Images) gelten als Ausgabe des Graphen.
+class RenderGraph {
+
+    public:
+        using PassCallback = std::function<void(VkCommandBuffer)>;
+
+        class PassBuilder {
+
+            private:
+                RenderGraph& graph;
+                uint32_t pass;
+
+            public:
+                PassBuilder(RenderGraph& graph, uint32_t pass);
+
+                // Ohne Clear-Wert wird der bisherige Inhalt geladen, falls es einen gibt.
+                PassBuilder& colorAttachment(RenderResource resource, std::optional<VkClearColorValue> clear = std::nullopt);
+                PassBuilder& depthAttachment(RenderResource resource, std::optional<VkClearDepthStencilValue> clear = std::nullopt);
+
+                // Löst das Multisample-Attachment source am Ende des Passes in target auf, ohne eigenen Pass.
+                // source muss vorher mit colorAttachment() angegeben sein.
+                PassBuilder& resolve(RenderResource source, RenderResource target);
+
+                PassBuilder& read(RenderResource resource, ResourceUsage usage, VkPipelineStageFlags2 stages);
+                PassBuilder& write(RenderResource resource, ResourceUsage usage, VkPipelineStageFlags2 stages);
+
+                // Der Pass wird nie verworfen, auch wenn niemand sein Ergebnis liest.
+                PassBuilder& sideEffect();
+
+                PassBuilder& execute(PassCallback callback);
+        };
+
+    private:
+        static constexpr RenderResource NO_RESOURCE = UINT32_MAX;
+
+        struct Access {
+            RenderResource resource;
+            ResourceUsage usage;
+            VkPipelineStageFlags2 stages;
+            bool write;
+            bool clear;
+            VkClearValue clearValue;
+            VkAttachmentLoadOp loadOp;
+            VkAttachmentStoreOp storeOp;
+
+            // Bei Color Attachments das Ziel der Auflösung, beim Ziel selbst ist resolve gesetzt
+            RenderResource resolveTarget = NO_RESOURCE;
+            bool resolve = false;
+        };
+
+        struct Barrier {
+            RenderResource resource;
+            VkPipelineStageFlags2 srcStageMask;
+            VkPipelineStageFlags2 dstStageMask;
+            VkAccessFlags2 srcAccessMask;
+            VkAccessFlags2 dstAccessMask;
+            VkImageLayout oldLayout;
+            VkImageLayout newLayout;
+        };
+
+        struct Pass {
+            std::string name;
+            std::vector<Access> accesses;
+            PassCallback callback;
+            bool sideEffect = false;
+            bool culled = false;
+            std::vector<Barrier> barriers;
+        };
+
+        struct Resource {
+            std::string name;
+            bool imported = false;
+            VkFormat format;
+            VkExtent2D extent;
+            VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+            VkImageAspectFlags aspectMask;
+
+            // Nur für importierte Images
+            VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags2 initialStages = VK_PIPELINE_STAGE_2_NONE;
+
+            VkImageUsageFlags usage = 0;
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView imageView = VK_NULL_HANDLE;
+
+            // Erster und letzter nicht verworfener Pass, der das Image benutzt
+            uint32_t firstPass = UINT32_MAX;
+            uint32_t lastPass = 0;
+
+            // Liegt im Speicher für transiente Attachments statt im normalen Speicher
+            bool lazy = false;
+            VkDeviceSize memoryOffset = 0;
+            VkDeviceSize memorySize = 0;
+        };
+
+        MemoryTypeSelector* memoryTypes = nullptr;
+        VkDevice device = VK_NULL_HANDLE;
+
+        std::vector<Resource> resources;
+        std::vector<Pass> passes;
+        std::vector<Barrier> finalBarriers;
+
+        VkDeviceMemory transientMemory = VK_NULL_HANDLE;
+        VkDeviceMemory lazyMemory = VK_NULL_HANDLE;
+
+        BarrierBatch barrierBatch;
+        RenderGraphStats stats;
+        bool compiled = false;
+
+    public:
+        void create(MemoryTypeSelector& memoryTypes, VkDevice device, bool synchronization2);
+        void destroy();
+
+        // initialStages ist die Stage, ab der der Inhalt geschrieben werden darf, z.B. die Wait-Stage des Acquire-Semaphores.
+        RenderResource importImage(const std::string& name, VkFormat format, VkExtent2D extent, VkImageLayout finalLayout, VkPipelineStageFlags2 initialStages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+        RenderResource createImage(const std::string& name, const TransientImageDesc& desc);
+
+        PassBuilder addPass(const std::string& name);
+
+        // Nach dem Hinzufügen aller Passes einmal aufrufen.
+        void compile();
+
+        // Importierte Images können sich jeden Frame ändern, z.B. mit dem Swapchain Image Index.
+        void setImportedImage(RenderResource resource, VkImage image, VkImageView imageView);
+
+        void execute(VkCommandBuffer commandBuffer);
+
+        VkImage getImage(RenderResource resource) const;
+        VkImageView getImageView(RenderResource resource) const;
+
+        RenderGraphStats getStats() const;
+        BarrierBatchStats getBarrierStats() const;
+        bool usesSynchronization2() const;
+
+        // Gibt für jeden Pass aus, ob er verworfen wurde und welche Barrieren vor ihm liegen.
+        void print() const;
+
+    private:
+        void addAccess(uint32_t pass, const Access& access);
+        void cullPasses();
+        void computeLifetimes();
+        void allocateTransients();
+        VkDeviceSize placeTransients(const std::vector<RenderResource>& transients);
+        VkDeviceMemory allocateMemory(const std::vector<RenderResource>& transients, VkDeviceSize size, uint32_t memoryTypeBits, VkMemoryPropertyFlags required);
+        void planBarriers();
+
+        static bool isWrite(ResourceUsage usage);
+        static VkImageLayout layoutFor(ResourceUsage usage);
+        static VkAccessFlags2 accessFor(ResourceUsage usage, bool write);
+        static VkImageUsageFlags imageUsageFor(ResourceUsage usage);
+        static VkImageAspectFlags aspectFor(VkFormat format);
+        static bool isAttachment(ResourceUsage usage);
+};
+
+inline RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, uint32_t pass) : graph(graph), pass(pass) {
+}
+
+inline RenderGraph::PassBuilder& RenderGraph::PassBuilder::colorAttachment(RenderResource resource, std::optional<VkClearColorValue> clear) {
+
+    Access access {};
+    access.resource = resource;
+    access.usage = ResourceUsage::ColorAttachment;
+    access.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    access.write = true;
+    access.clear = clear.has_value();
+    if (clear) {
+        access.clearValue.color = *clear;
+    }
+
+    graph.addAccess(pass, access);
+    return *this;
+}
+
+inline RenderGraph::PassBuilder& RenderGraph::PassBuilder::depthAttachment(RenderResource resource, std::optional<VkClearDepthStencilValue> clear) {
+
+    Access access {};
+    access.resource = resource;
+    access.usage = ResourceUsage::DepthAttachment;
+    access.stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+    access.write = true;
+    access.clear = clear.has_value();
+    if (clear) {
+        access.clearValue.depthStencil = *clear;
+    }
+
+    graph.addAccess(pass, access);
+    return *this;
+}
+
+inline RenderGraph::PassBuilder& RenderGraph::PassBuilder::resolve(RenderResource source, RenderResource target) {
+
+    auto sourceAccess = std::find_if(graph.passes[pass].accesses.begin(), graph.passes[pass].accesses.end(), [source](const Access& access) {
+        return access.resource == source && access.usage == ResourceUsage::ColorAttachment;
+    });
+
+    if (sourceAccess == graph.passes[pass].accesses.end()) {
+        std::cerr << "Render Graph: " << graph.passes[pass].name << " löst ein Image auf, das kein Color Attachment des Passes ist!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    sourceAccess->resolveTarget = target;
+
+    // Die Auflösung schreibt das Ziel vollständig, in der Color-Attachment-Stage
+    Access access {};
+    access.resource = target;
+    access.usage = ResourceUsage::ColorAttachment;
+    access.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    access.write = true;
+    access.clear = true;
+    access.resolve = true;
+
+    graph.addAccess(pass, access);
+    return *this;
+}
+
+inline RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(RenderResource resource, ResourceUsage usage, VkPipelineStageFlags2 stages) {
+
+    Access access {};
+    access.resource = resource;
+    access.usage = usage;
+    access.stages = stages;
+    access.write = false;
+
+    graph.addAccess(pass, access);
+    return *this;
+}
+
+inline RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(RenderResource resource, ResourceUsage usage, VkPipelineStageFlags2 stages) {
+
+    if (!isWrite(usage)) {
+        std::cerr << "Render Graph: " << graph.passes[pass].name << " kann ein Image nicht mit dieser Nutzung schreiben!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    Access access {};
+    access.resource = resource;
+    access.usage = usage;
+    access.stages = stages;
+    access.write = true;
+
+    // Storage Images werden gelesen und geschrieben, Transfers überschreiben immer
+    access.clear = usage == ResourceUsage::TransferDst;
+
+    graph.addAccess(pass, access);
+    return *this;
+}
+
+inline RenderGraph::PassBuilder& RenderGraph::PassBuilder::sideEffect() {
+
+    graph.passes[pass].sideEffect = true;
+    return *this;
+}
+
+inline RenderGraph::PassBuilder& RenderGraph::PassBuilder::execute(PassCallback callback) {
+
+    graph.passes[pass].callback = std::move(callback);
+    return *this;
+}
+
+inline void RenderGraph::create(MemoryTypeSelector& memoryTypes, VkDevice device, bool synchronization2) {
+
+    this->memoryTypes = &memoryTypes;
+    this->device = device;
+
+    barrierBatch.create(synchronization2);
+}
+
+inline void RenderGraph::destroy() {
+
+    for (Resource& resource : resources) {
+        if (resource.imported) {
+            continue;
+        }
+        vkDestroyImageView(device, resource.imageView, nullptr);
+        vkDestroyImage(device, resource.image, nullptr);
+    }
+
+    if (transientMemory != VK_NULL_HANDLE) {
+        memoryTypes->free(device, transientMemory);
+        transientMemory = VK_NULL_HANDLE;
+    }
+
+    if (lazyMemory != VK_NULL_HANDLE) {
+        memoryTypes->free(device, lazyMemory);
+        lazyMemory = VK_NULL_HANDLE;
+    }
+
+    resources.clear();
+    passes.clear();
+    finalBarriers.clear();
+    compiled = false;
+}
+
+inline RenderResource RenderGraph::importImage(const std::string& name, VkFormat format, VkExtent2D extent, VkImageLayout finalLayout, VkPipelineStageFlags2 initialStages) {
+
+    Resource resource {};
+    resource.name = name;
+    resource.imported = true;
+    resource.format = format;
+    resource.extent = extent;
+    resource.aspectMask = aspectFor(format);
+    resource.finalLayout = finalLayout;
+    resource.initialStages = initialStages;
+
+    resources.push_back(resource);
+    return static_cast<RenderResource>(resources.size() - 1);
+}
+
+inline RenderResource RenderGraph::createImage(const std::string& name, const TransientImageDesc& desc) {
+
+    Resource resource {};
+    resource.name = name;
+    resource.imported = false;
+    resource.format = desc.format;
+    resource.extent = desc.extent;
+    resource.samples = desc.samples;
+    resource.aspectMask = aspectFor(desc.format);
+
+    resources.push_back(resource);
+    return static_cast<RenderResource>(resources.size() - 1);
+}
+
+inline RenderGraph::PassBuilder RenderGraph::addPass(const std::string& name) {
+
+    Pass pass {};
+    pass.name = name;
+    passes.push_back(pass);
+
+    return PassBuilder(*this, static_cast<uint32_t>(passes.size() - 1));
+}
+
+inline void RenderGraph::addAccess(uint32_t pass, const Access& access) {
+
+    if (access.resource >= resources.size()) {
+        std::cerr << "Render Graph: " << passes[pass].name << " benutzt ein unbekanntes Image!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    passes[pass].accesses.push_back(access);
+}
+
+inline bool RenderGraph::isWrite(ResourceUsage usage) {
+    return usage == ResourceUsage::ColorAttachment || usage == ResourceUsage::DepthAttachment || usage == ResourceUsage::Storage || usage == ResourceUsage::TransferDst;
+}
+
+inline bool RenderGraph::isAttachment(ResourceUsage usage) {
+    return usage == ResourceUsage::ColorAttachment || usage == ResourceUsage::DepthAttachment;
+}
+
+inline VkImageLayout RenderGraph::layoutFor(ResourceUsage usage) {
+
+    switch (usage) {
+        case ResourceUsage::ColorAttachment:
+            return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        case ResourceUsage::DepthAttachment:
+            return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        case ResourceUsage::Sampled:
+            return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        case ResourceUsage::Storage:
+            return VK_IMAGE_LAYOUT_GENERAL;
+        case ResourceUsage::TransferSrc:
+            return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        case ResourceUsage::TransferDst:
+            return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    }
+
+    return VK_IMAGE_LAYOUT_GENERAL;
+}
+
+inline VkAccessFlags2 RenderGraph::accessFor(ResourceUsage usage, bool write) {
+
+    switch (usage) {
+        case ResourceUsage::ColorAttachment:
+            return VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        case ResourceUsage::DepthAttachment:
+            return VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        case ResourceUsage::Sampled:
+            return VK_ACCESS_2_SHADER_READ_BIT;
+        case ResourceUsage::Storage:
+            return write ? VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT : VK_ACCESS_2_SHADER_READ_BIT;
+        case ResourceUsage::TransferSrc:
+            return VK_ACCESS_2_TRANSFER_READ_BIT;
+        case ResourceUsage::TransferDst:
+            return VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    }
+
+    return VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+}
+
+inline VkImageUsageFlags RenderGraph::imageUsageFor(ResourceUsage usage) {
+
+    switch (usage) {
+        case ResourceUsage::ColorAttachment:
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        case ResourceUsage::DepthAttachment:
+            return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        case ResourceUsage::Sampled:
+            return VK_IMAGE_USAGE_SAMPLED_BIT;
+        case ResourceUsage::Storage:
+            return VK_IMAGE_USAGE_STORAGE_BIT;
+        case ResourceUsage::TransferSrc:
+            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        case ResourceUsage::TransferDst:
+            return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+
+    return 0;
+}
+
+inline VkImageAspectFlags RenderGraph::aspectFor(VkFormat format) {
+
+    switch (format) {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+inline void RenderGraph::cullPasses() {
+
+    // Rückwärts durch die Passes: gebraucht wird, was die Ausgaben des Graphen oder ein gebrauchter Pass liest
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t i = 0; i < resources.size(); i++) {
+        needed[i] = resources[i].imported;
+    }
+
+    for (size_t p = passes.size(); p-- > 0;) {
+
+        Pass& pass = passes[p];
+
+        bool live = pass.sideEffect;
+        for (const Access& access : pass.accesses) {
+            if (access.write && needed[access.resource]) {
+                live = true;
+            }
+        }
+
+        pass.culled = !live;
+        if (pass.culled) {
+            continue;
+        }
+
+        // Vollständig überschriebene Images brauchen keinen früheren Inhalt mehr
+        for (const Access& access : pass.accesses) {
+            if (access.write && access.clear && !resources[access.resource].imported) {
+                needed[access.resource] = false;
+            }
+        }
+
+        for (const Access& access : pass.accesses) {
+            if (!access.write || !access.clear) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+}
+
+inline void RenderGraph::computeLifetimes() {
+
+    for (uint32_t p = 0; p < passes.size(); p++) {
+
+        if (passes[p].culled) {
+            continue;
+        }
+
+        for (const Access& access : passes[p].accesses) {
+            Resource& resource = resources[access.resource];
+            resource.firstPass = std::min(resource.firstPass, p);
+            resource.lastPass = std::max(resource.lastPass, p);
+            resource.usage |= imageUsageFor(access.usage);
+        }
+    }
+}
+
+inline void RenderGraph::allocateTransients() {
+
+    std::vector<RenderResource> transients;
+    std::vector<RenderResource> lazyTransients;
+
+    for (RenderResource r = 0; r < resources.size(); r++) {
+
+        Resource& resource = resources[r];
+
+        // Images, die kein Pass benutzt, werden gar nicht erst angelegt
+        if (resource.imported || resource.firstPass == UINT32_MAX) {
+            continue;
+        }
+
+        // Nur Attachment eines einzigen Passes: der Inhalt muss den Tile-Speicher nie verlassen
+        const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        resource.lazy = resource.firstPass == resource.lastPass && (resource.usage & ~attachmentUsage) == 0;
+
+        VkImageCreateInfo imageCreateInfo {};
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format = resource.format;
+        imageCreateInfo.extent = { resource.extent.width, resource.extent.height, 1 };
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.samples = resource.samples;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage = resource.usage | (resource.lazy ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0);
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageCreateInfo, nullptr, &resource.image) != VK_SUCCESS) {
+            std::cerr << "Render Graph: Image " << resource.name << " konnte nicht erstellt werden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (resource.lazy) {
+            lazyTransients.push_back(r);
+        } else {
+            transients.push_back(r);
+        }
+    }
+
+    // Ohne Lazily Allocated Memory (z.B. auf Desktop-GPUs) teilen sich alle Images denselben Speicher
+    if (!lazyTransients.empty()) {
+
+        uint32_t memoryTypeBits = UINT32_MAX;
+        for (RenderResource r : lazyTransients) {
+            VkMemoryRequirements memoryRequirements;
+            vkGetImageMemoryRequirements(device, resources[r].image, &memoryRequirements);
+            memoryTypeBits &= memoryRequirements.memoryTypeBits;
+        }
+
+        const VkMemoryPropertyFlags lazyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+        if (memoryTypes->findMemoryType(memoryTypeBits, lazyFlags, 0, 0, false) == UINT32_MAX) {
+            for (RenderResource r : lazyTransients) {
+                resources[r].lazy = false;
+                transients.push_back(r);
+            }
+            lazyTransients.clear();
+        } else {
+            const VkDeviceSize size = placeTransients(lazyTransients);
+            lazyMemory = allocateMemory(lazyTransients, size, memoryTypeBits, lazyFlags);
+
+            stats.lazyImages = static_cast<uint32_t>(lazyTransients.size());
+            stats.lazyBytes = size;
+        }
+    }
+
+    if (!transients.empty()) {
+
+        uint32_t memoryTypeBits = UINT32_MAX;
+        for (RenderResource r : transients) {
+            VkMemoryRequirements memoryRequirements;
+            vkGetImageMemoryRequirements(device, resources[r].image, &memoryRequirements);
+            memoryTypeBits &= memoryRequirements.memoryTypeBits;
+        }
+
+        if (memoryTypes->findMemoryType(memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, 0, false) == UINT32_MAX) {
+            std::cerr << "Render Graph: Kein gemeinsamer Speichertyp für die transienten Images gefunden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        const VkDeviceSize size = placeTransients(transients);
+        transientMemory = allocateMemory(transients, size, memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        stats.transientBytes += size;
+    }
+
+    stats.transientImages = static_cast<uint32_t>(transients.size() + lazyTransients.size());
+    stats.transientBytes += stats.lazyBytes;
+}
+
+inline VkDeviceSize RenderGraph::placeTransients(const std::vector<RenderResource>& transients) {
+
+    // Erst nach Lebensbeginn sortiert platzieren, dann landet jedes Image am niedrigsten Offset,
+    // an dem kein gleichzeitig lebendes Image liegt
+    std::vector<RenderResource> sorted = transients;
+    std::sort(sorted.begin(), sorted.end(), [this](RenderResource a, RenderResource b) {
+        return resources[a].firstPass < resources[b].firstPass;
+    });
+
+    std::vector<RenderResource> placed;
+    VkDeviceSize totalSize = 0;
+
+    for (RenderResource r : sorted) {
+
+        Resource& resource = resources[r];
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(device, resource.image, &memoryRequirements);
+
+        resource.memorySize = memoryRequirements.size;
+        stats.transientBytesWithoutAliasing += memoryRequirements.size;
+
+        std::vector<std::pair<VkDeviceSize, VkDeviceSize>> occupied;
+        for (RenderResource other : placed) {
+            const Resource& otherResource = resources[other];
+            if (otherResource.firstPass <= resource.lastPass && resource.firstPass <= otherResource.lastPass) {
+                occupied.emplace_back(otherResource.memoryOffset, otherResource.memoryOffset + otherResource.memorySize);
+            }
+        }
+        std::sort(occupied.begin(), occupied.end());
+
+        const VkDeviceSize alignment = memoryRequirements.alignment;
+        VkDeviceSize offset = 0;
+        for (const auto& [begin, end] : occupied) {
+            if (offset + resource.memorySize <= begin) {
+                break;
+            }
+            offset = std::max(offset, (end + alignment - 1) / alignment * alignment);
+        }
+
+        resource.memoryOffset = offset;
+        totalSize = std::max(totalSize, offset + resource.memorySize);
+        placed.push_back(r);
+    }
+
+    for (RenderResource r : placed) {
+        const Resource& resource = resources[r];
+        const bool aliased = std::any_of(placed.begin(), placed.end(), [&](RenderResource other) {
+            const Resource& otherResource = resources[other];
+            return other != r && otherResource.memoryOffset < resource.memoryOffset + resource.memorySize && resource.memoryOffset < otherResource.memoryOffset + otherResource.memorySize;
+        });
+        if (aliased) {
+            stats.aliasedImages++;
+        }
+    }
+
+    return totalSize;
+}
+
+inline VkDeviceMemory RenderGraph::allocateMemory(const std::vector<RenderResource>& transients, VkDeviceSize size, uint32_t memoryTypeBits, VkMemoryPropertyFlags required) {
+
+    // Die Alignments sind schon in placeTransients berücksichtigt
+    VkMemoryRequirements memoryRequirements {};
+    memoryRequirements.size = size;
+    memoryRequirements.alignment = 1;
+    memoryRequirements.memoryTypeBits = memoryTypeBits;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (memoryTypes->allocate(device, memoryRequirements, required, 0, memory) != VK_SUCCESS) {
+        std::cerr << "Render Graph: Speicher für die transienten Images konnte nicht reserviert werden!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    for (RenderResource r : transients) {
+
+        Resource& resource = resources[r];
+        vkBindImageMemory(device, resource.image, memory, resource.memoryOffset);
+
+        VkImageViewCreateInfo imageViewCreateInfo {};
+        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCreateInfo.image = resource.image;
+        imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewCreateInfo.format = resource.format;
+        imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.subresourceRange.aspectMask = resource.aspectMask;
+        imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &imageViewCreateInfo, nullptr, &resource.imageView) != VK_SUCCESS) {
+            std::cerr << "Render Graph: Image View " << resource.name << " konnte nicht erstellt werden!" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    return memory;
+}
+
+inline void RenderGraph::planBarriers() {
+
+    struct ResourceState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+
+        // Stages, die seit dem letzten Schreiben gelesen haben bzw. den Schreibzugriff schon sehen
+        VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;
+        VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE;
+        bool written = false;
+    };
+
+    std::vector<ResourceState> states(resources.size());
+
+    for (RenderResource r = 0; r < resources.size(); r++) {
+        // Der erste Übergang importierter Images muss auf die Stage warten, ab der sie verfügbar sind
+        states[r].writeStages = resources[r].imported ? resources[r].initialStages : VK_PIPELINE_STAGE_2_NONE;
+    }
+
+    // Ein transientes Image darf erst beschrieben werden, wenn alle Images im selben Speicher fertig sind,
+    // auch die aus dem vorherigen Frame. Das schließt das Image selbst mit ein.
+    for (RenderResource r = 0; r < resources.size(); r++) {
+
+        const Resource& resource = resources[r];
+        if (resource.imported || resource.image == VK_NULL_HANDLE) {
+            continue;
+        }
+
+        for (RenderResource other = 0; other < resources.size(); other++) {
+
+            const Resource& otherResource = resources[other];
+            if (otherResource.imported || otherResource.image == VK_NULL_HANDLE) {
+                continue;
+            }
+
+            // Images in verschiedenen Allokationen überschneiden sich nie, außer mit sich selbst
+            const bool overlaps = otherResource.lazy == resource.lazy && otherResource.memoryOffset < resource.memoryOffset + resource.memorySize && resource.memoryOffset < otherResource.memoryOffset + otherResource.memorySize;
+            if (!overlaps) {
+                continue;
+            }
+
+            for (const Pass& pass : passes) {
+                if (pass.culled) {
+                    continue;
+                }
+                for (const Access& access : pass.accesses) {
+                    if (access.resource == other) {
+                        states[r].writeStages |= access.stages;
+                        if (access.write) {
+                            states[r].writeAccess |= accessFor(access.usage, true);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (uint32_t p = 0; p < passes.size(); p++) {
+
+        Pass& pass = passes[p];
+        pass.barriers.clear();
+
+        if (pass.culled) {
+            continue;
+        }
+
+        for (Access& access : pass.accesses) {
+
+            ResourceState& state = states[access.resource];
+            const VkImageLayout layout = layoutFor(access.usage);
+            const VkAccessFlags2 accessMask = accessFor(access.usage, access.write);
+
+            if (isAttachment(access.usage)) {
+                if (access.clear) {
+                    access.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+                } else {
+                    access.loadOp = state.written ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                }
+            }
+
+            // Überschreiben braucht den alten Inhalt nicht, der Übergang kann von UNDEFINED aus passieren
+            const bool discard = access.write && (access.clear || !state.written);
+            const VkImageLayout oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+
+            bool needsBarrier;
+            if (layout != state.layout || discard) {
+                needsBarrier = layout != state.layout || state.writeStages != VK_PIPELINE_STAGE_2_NONE || state.readStages != VK_PIPELINE_STAGE_2_NONE;
+            } else if (access.write) {
+                needsBarrier = true;
+            } else {
+                // Lesen nach Lesen im selben Layout braucht nichts, ebenso wenn der Schreibzugriff schon sichtbar ist
+                needsBarrier = state.written && (access.stages & ~state.visibleStages) != 0;
+            }
+
+            if (needsBarrier) {
+
+                Barrier barrier {};
+                barrier.resource = access.resource;
+                barrier.srcStageMask = state.writeStages | state.readStages;
+                barrier.srcAccessMask = state.writeAccess;
+                barrier.dstStageMask = access.stages;
+                barrier.dstAccessMask = accessMask;
+                barrier.oldLayout = oldLayout;
+                barrier.newLayout = layout;
+
+                pass.barriers.push_back(barrier);
+
+                if (layout != state.layout || access.write) {
+                    state.visibleStages = access.stages;
+                } else {
+                    state.visibleStages |= access.stages;
+                }
+            }
+
+            state.layout = layout;
+
+            if (access.write) {
+                state.writeStages = access.stages;
+                state.writeAccess = accessMask;
+                state.readStages = VK_PIPELINE_STAGE_2_NONE;
+                state.visibleStages = VK_PIPELINE_STAGE_2_NONE;
+                state.written = true;
+            } else {
+                state.readStages |= access.stages;
+            }
+        }
+    }
+
+    // Den Inhalt behalten muss nur, wer danach noch gelesen wird oder den Graphen verlässt
+    for (uint32_t p = 0; p < passes.size(); p++) {
+
+        if (passes[p].culled) {
+            continue;
+        }
+
+        for (Access& access : passes[p].accesses) {
+
+            if (!isAttachment(access.usage)) {
+                continue;
+            }
+
+            bool keep = resources[access.resource].imported;
+            bool found = false;
+
+            for (uint32_t later = p + 1; later < passes.size() && !found; later++) {
+
+                if (passes[later].culled) {
+                    continue;
+                }
+
+                for (const Access& laterAccess : passes[later].accesses) {
+                    if (laterAccess.resource == access.resource) {
+                        keep = keep || !laterAccess.write || !laterAccess.clear;
+                        found = true;
+                        break;
+                    }
+                }
+            }
+
+            access.storeOp = keep ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        }
+    }
+
+    finalBarriers.clear();
+    for (RenderResource r = 0; r < resources.size(); r++) {
+
+        const Resource& resource = resources[r];
+        const ResourceState& state = states[r];
+
+        if (!resource.imported || resource.finalLayout == state.layout) {
+            continue;
+        }
+
+        Barrier barrier {};
+        barrier.resource = r;
+        barrier.srcStageMask = state.writeStages | state.readStages;
+        barrier.srcAccessMask = state.writeAccess;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+        barrier.oldLayout = state.written ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = resource.finalLayout;
+
+        finalBarriers.push_back(barrier);
+    }
+}
+
+inline void RenderGraph::compile() {
+
+    stats = {};
+
+    cullPasses();
+    computeLifetimes();
+    allocateTransients();
+    planBarriers();
+
+    stats.passes = static_cast<uint32_t>(passes.size());
+    for (const Pass& pass : passes) {
+        if (pass.culled) {
+            stats.culledPasses++;
+        } else {
+            stats.barriersPerFrame += static_cast<uint32_t>(pass.barriers.size());
+        }
+    }
+    stats.barriersPerFrame += static_cast<uint32_t>(finalBarriers.size());
+
+    compiled = true;
+}
+
+inline void RenderGraph::setImportedImage(RenderResource resource, VkImage image, VkImageView imageView) {
+
+    resources[resource].image = image;
+    resources[resource].imageView = imageView;
+}
+
+inline void RenderGraph::execute(VkCommandBuffer commandBuffer) {
+
+    if (!compiled) {
+        std::cerr << "Render Graph wurde nicht kompiliert!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<VkRenderingAttachmentInfo> colorAttachments;
+
+    for (const Pass& pass : passes) {
+
+        if (pass.culled) {
+            continue;
+        }
+
+        for (const Barrier& barrier : pass.barriers) {
+            const Resource& resource = resources[barrier.resource];
+            barrierBatch.imageTransition(barrier.srcStageMask, barrier.dstStageMask, barrier.srcAccessMask, barrier.dstAccessMask, barrier.oldLayout, barrier.newLayout, resource.image, resource.aspectMask);
+        }
+        barrierBatch.flush(commandBuffer);
+
+        colorAttachments.clear();
+        VkRenderingAttachmentInfo depthAttachment {};
+        bool hasDepthAttachment = false;
+        VkExtent2D renderExtent {};
+
+        for (const Access& access : pass.accesses) {
+
+            if (!isAttachment(access.usage) || access.resolve) {
+                continue;
+            }
+
+            VkRenderingAttachmentInfo renderingAttachmentInfo {};
+            renderingAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+            renderingAttachmentInfo.pNext = nullptr;
+            renderingAttachmentInfo.imageView = resources[access.resource].imageView;
+            renderingAttachmentInfo.imageLayout = layoutFor(access.usage);
+            renderingAttachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
+            renderingAttachmentInfo.resolveImageView = VK_NULL_HANDLE;
+            renderingAttachmentInfo.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            // Die Auflösung passiert beim Speichern des Tiles, die Samples selbst müssen nie in den Speicher
+            if (access.resolveTarget != NO_RESOURCE) {
+                renderingAttachmentInfo.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+                renderingAttachmentInfo.resolveImageView = resources[access.resolveTarget].imageView;
+                renderingAttachmentInfo.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            }
+            renderingAttachmentInfo.loadOp = access.loadOp;
+            renderingAttachmentInfo.storeOp = access.storeOp;
+            renderingAttachmentInfo.clearValue = access.clearValue;
+
+            renderExtent = resources[access.resource].extent;
+
+            if (access.usage == ResourceUsage::DepthAttachment) {
+                depthAttachment = renderingAttachmentInfo;
+                hasDepthAttachment = true;
+            } else {
+                colorAttachments.push_back(renderingAttachmentInfo);
+            }
+        }
+
+        const bool rendering = !colorAttachments.empty() || hasDepthAttachment;
+
+        if (rendering) {
+
+            VkRenderingInfoKHR renderingInfo {};
+            renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+            renderingInfo.pNext = nullptr;
+            renderingInfo.flags = 0;
+            renderingInfo.renderArea.offset = { 0, 0 };
+            renderingInfo.renderArea.extent = renderExtent;
+            renderingInfo.layerCount = 1;
+            renderingInfo.viewMask = 0;
+            renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+            renderingInfo.pColorAttachments = colorAttachments.data();
+            renderingInfo.pDepthAttachment = hasDepthAttachment ? &depthAttachment : nullptr;
+            renderingInfo.pStencilAttachment = nullptr;
+
+            deviceDispatch.vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+        }
+
+        if (pass.callback) {
+            pass.callback(commandBuffer);
+        }
+
+        if (rendering) {
+            deviceDispatch.vkCmdEndRenderingKHR(commandBuffer);
+        }
+    }
+
+    for (const Barrier& barrier : finalBarriers) {
+        const Resource& resource = resources[barrier.resource];
+        barrierBatch.imageTransition(barrier.srcStageMask, barrier.dstStageMask, barrier.srcAccessMask, barrier.dstAccessMask, barrier.oldLayout, barrier.newLayout, resource.image, resource.aspectMask);
+    }
+    barrierBatch.flush(commandBuffer);
+    barrierBatch.endFrame();
+}
+
+inline VkImage RenderGraph::getImage(RenderResource resource) const {
+    return resources[resource].image;
+}
+
+inline VkImageView RenderGraph::getImageView(RenderResource resource) const {
+    return resources[resource].imageView;
+}
+
+inline RenderGraphStats RenderGraph::getStats() const {
+    return stats;
+}
+
+inline BarrierBatchStats RenderGraph::getBarrierStats() const {
+    return barrierBatch.getStats();
+}
+
+inline bool RenderGraph::usesSynchronization2() const {
+    return barrierBatch.usesSynchronization2();
+}
+
+inline void RenderGraph::print() const {
+
+    for (const Pass& pass : passes) {
+
+        if (pass.culled) {
+            std::cout << "Render Graph: " << pass.name << " (verworfen)" << std::endl;
+            continue;
+        }
+
+        std::cout << "Render Graph: " << pass.name << ", " << pass.barriers.size() << " Barrieren" << std::endl;
+        for (const Barrier& barrier : pass.barriers) {
+            std::cout << "    " << resources[barrier.resource].name << ": Layout " << barrier.oldLayout << " -> " << barrier.newLayout << std::endl;
+        }
+    }
+
+    for (const Resource& resource : resources) {
+        if (!resource.imported && resource.image != VK_NULL_HANDLE) {
+            std::cout << "Render Graph: " << resource.name << " liegt bei Offset " << resource.memoryOffset << (resource.lazy ? " im Lazy-Speicher" : "") << " (" << resource.memorySize << " Bytes, Passes " << resource.firstPass << "-" << resource.lastPass << ")" << std::endl;
+        }
+    }
+}
+
+#endif //RENDER_GRAPH_H
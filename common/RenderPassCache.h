@@ -0,0 +1,402 @@
+#ifndef RENDER_PASS_CACHE_H
+#define RENDER_PASS_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Alles, was einen Render Pass mit einem Color- und optional einem Depth-Attachment festlegt.
+// Mit samples > 1 gelten die Color Ops für das Multisample-Image, das Ergebnis wird immer aufgelöst und gespeichert.
+struct RenderPassKey {
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkAttachmentLoadOp colorLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    VkAttachmentStoreOp colorStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+    VkAttachmentLoadOp depthLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    VkAttachmentStoreOp depthStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    bool operator==(const RenderPassKey& other) const = default;
+};
+
+// Attachments in der Reihenfolge des Render Passes: Color, Depth, Resolve. Unbenutzte sind VK_NULL_HANDLE.
+struct FramebufferKey {
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    std::array<VkImageView, 3> attachments {};
+    uint32_t attachmentCount = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool operator==(const FramebufferKey& other) const = default;
+};
+
+inline size_t hashCombine(size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+struct RenderPassKeyHash {
+    size_t operator()(const RenderPassKey& key) const {
+        size_t seed = 0;
+        seed = hashCombine(seed, key.colorFormat);
+        seed = hashCombine(seed, key.depthFormat);
+        seed = hashCombine(seed, key.samples);
+        seed = hashCombine(seed, key.colorLoadOp);
+        seed = hashCombine(seed, key.colorStoreOp);
+        seed = hashCombine(seed, key.depthLoadOp);
+        seed = hashCombine(seed, key.depthStoreOp);
+        seed = hashCombine(seed, key.finalLayout);
+        return seed;
+    }
+};
+
+struct FramebufferKeyHash {
+    size_t operator()(const FramebufferKey& key) const {
+        size_t seed = std::hash<VkRenderPass>{}(key.renderPass);
+        for (VkImageView attachment : key.attachments) {
+            seed = hashCombine(seed, std::hash<VkImageView>{}(attachment));
+        }
+        seed = hashCombine(seed, key.width);
+        seed = hashCombine(seed, key.height);
+        return seed;
+    }
+};
+
+// Handles nach Key, vorne das zuletzt benutzte. So liegen die Kandidaten zum Verwerfen immer hinten.
+template<typename Key, typename Handle, typename Hash>
+class LruHandleCache {
+
+    private:
+        struct Entry {
+            Key key;
+            Handle handle;
+            uint64_t lastUsedFrame;
+        };
+
+        std::list<Entry> entries;
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> lookup;
+
+    public:
+        // Liefert VK_NULL_HANDLE, wenn der Key unbekannt ist
+        Handle find(const Key& key, uint64_t frame) {
+
+            const auto it = lookup.find(key);
+            if (it == lookup.end()) {
+                return VK_NULL_HANDLE;
+            }
+
+            it->second->lastUsedFrame = frame;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->handle;
+        }
+
+        void insert(const Key& key, Handle handle, uint64_t frame) {
+            entries.push_front({ key, handle, frame });
+            lookup[key] = entries.begin();
+        }
+
+        // Verwirft alle Einträge, die zuletzt vor oldestFrame benutzt wurden
+        template<typename Destroy>
+        uint32_t evict(uint64_t oldestFrame, Destroy destroy) {
+
+            uint32_t evicted = 0;
+            while (!entries.empty() && entries.back().lastUsedFrame < oldestFrame) {
+                destroy(entries.back().handle);
+                lookup.erase(entries.back().key);
+                entries.pop_back();
+                evicted++;
+            }
+
+            return evicted;
+        }
+
+        template<typename Destroy>
+        void clear(Destroy destroy) {
+
+            for (const Entry& entry : entries) {
+                destroy(entry.handle);
+            }
+
+            entries.clear();
+            lookup.clear();
+        }
+
+        size_t size() const {
+            return entries.size();
+        }
+};
+
+struct RenderPassCacheStats {
+    uint32_t renderPassesCreated = 0;
+    uint32_t framebuffersCreated = 0;
+    uint32_t renderPassesEvicted = 0;
+    uint32_t framebuffersEvicted = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t renderPasses = 0;
+    size_t framebuffers = 0;
+};
+
+// Erstellt Render Passes und Framebuffer bei Bedarf und behält sie, solange sie benutzt werden.
+// Einträge, die maxUnusedFrames Frames lang nicht benutzt wurden, werden zerstört. Damit das
+// sicher ist, muss maxUnusedFrames mindestens der Anzahl Frames in Flight entsprechen.
+class RenderPassCache {
+
+    private:
+        VkDevice device = VK_NULL_HANDLE;
+        uint32_t maxUnusedFrames = 0;
+        uint64_t frame = 0;
+
+        LruHandleCache<RenderPassKey, VkRenderPass, RenderPassKeyHash> renderPasses;
+        LruHandleCache<FramebufferKey, VkFramebuffer, FramebufferKeyHash> framebuffers;
+
+        RenderPassCacheStats stats;
+
+    public:
+        void create(VkDevice device, uint32_t maxUnusedFrames);
+        void destroy();
+
+        VkRenderPass getRenderPass(const RenderPassKey& key);
+        VkFramebuffer getFramebuffer(const FramebufferKey& key);
+
+        // Einmal pro Frame aufrufen, verwirft dabei die Einträge, die zu lange nicht benutzt wurden.
+        void endFrame();
+
+        RenderPassCacheStats getStats() const;
+
+        static VkImageAspectFlags depthAspect(VkFormat format);
+
+    private:
+        VkRenderPass createRenderPass(const RenderPassKey& key);
+        VkFramebuffer createFramebuffer(const FramebufferKey& key);
+};
+
+inline void RenderPassCache::create(VkDevice device, uint32_t maxUnusedFrames) {
+    this->device = device;
+    this->maxUnusedFrames = maxUnusedFrames;
+}
+
+inline void RenderPassCache::destroy() {
+
+    // Framebuffer zuerst, sie verweisen auf die Render Passes
+    framebuffers.clear([this](VkFramebuffer framebuffer) {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    });
+
+    renderPasses.clear([this](VkRenderPass renderPass) {
+        vkDestroyRenderPass(device, renderPass, nullptr);
+    });
+}
+
+inline VkImageAspectFlags RenderPassCache::depthAspect(VkFormat format) {
+
+    switch (format) {
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+    }
+}
+
+inline VkRenderPass RenderPassCache::getRenderPass(const RenderPassKey& key) {
+
+    VkRenderPass renderPass = renderPasses.find(key, frame);
+    if (renderPass != VK_NULL_HANDLE) {
+        stats.hits++;
+        return renderPass;
+    }
+
+    stats.misses++;
+    renderPass = createRenderPass(key);
+    renderPasses.insert(key, renderPass, frame);
+
+    return renderPass;
+}
+
+inline VkFramebuffer RenderPassCache::getFramebuffer(const FramebufferKey& key) {
+
+    VkFramebuffer framebuffer = framebuffers.find(key, frame);
+    if (framebuffer != VK_NULL_HANDLE) {
+        stats.hits++;
+        return framebuffer;
+    }
+
+    stats.misses++;
+    framebuffer = createFramebuffer(key);
+    framebuffers.insert(key, framebuffer, frame);
+
+    return framebuffer;
+}
+
+inline VkRenderPass RenderPassCache::createRenderPass(const RenderPassKey& key) {
+
+    const bool multisampled = key.samples != VK_SAMPLE_COUNT_1_BIT;
+    const bool depth = key.depthFormat != VK_FORMAT_UNDEFINED;
+    const bool colorLoad = key.colorLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+    const bool depthLoad = depth && key.depthLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+
+    // Reihenfolge der Attachments: Color, Depth, Resolve
+    std::vector<VkAttachmentDescription> attachmentDescriptions;
+
+    // Beim Laden liegt das Image noch im finalLayout des vorigen Passes
+    VkAttachmentDescription colorAttachment {};
+    colorAttachment.flags = 0;
+    colorAttachment.format = key.colorFormat;
+    colorAttachment.samples = key.samples;
+    colorAttachment.loadOp = key.colorLoadOp;
+    colorAttachment.storeOp = key.colorStoreOp;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = colorLoad ? (multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : key.finalLayout) : VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : key.finalLayout;
+    attachmentDescriptions.push_back(colorAttachment);
+
+    VkAttachmentReference colorReference {};
+    colorReference.attachment = 0;
+    colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthReference {};
+    if (depth) {
+
+        VkAttachmentDescription depthAttachment {};
+        depthAttachment.flags = 0;
+        depthAttachment.format = key.depthFormat;
+        depthAttachment.samples = key.samples;
+        depthAttachment.loadOp = key.depthLoadOp;
+        depthAttachment.storeOp = key.depthStoreOp;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = depthLoad ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        depthReference.attachment = static_cast<uint32_t>(attachmentDescriptions.size());
+        depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        attachmentDescriptions.push_back(depthAttachment);
+    }
+
+    VkAttachmentReference resolveReference {};
+    if (multisampled) {
+
+        VkAttachmentDescription resolveAttachment {};
+        resolveAttachment.flags = 0;
+        resolveAttachment.format = key.colorFormat;
+        resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        resolveAttachment.finalLayout = key.finalLayout;
+
+        resolveReference.attachment = static_cast<uint32_t>(attachmentDescriptions.size());
+        resolveReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachmentDescriptions.push_back(resolveAttachment);
+    }
+
+    VkSubpassDescription subpassDescription {};
+    subpassDescription.flags = 0;
+    subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpassDescription.inputAttachmentCount = 0;
+    subpassDescription.pInputAttachments = nullptr;
+    subpassDescription.colorAttachmentCount = 1;
+    subpassDescription.pColorAttachments = &colorReference;
+    subpassDescription.pResolveAttachments = multisampled ? &resolveReference : nullptr;
+    subpassDescription.pDepthStencilAttachment = depth ? &depthReference : nullptr;
+    subpassDescription.preserveAttachmentCount = 0;
+    subpassDescription.pPreserveAttachments = nullptr;
+
+    // Depth und MSAA-Color werden von Frame zu Frame wiederverwendet, der Clear muss auf den vorigen Frame warten
+    VkSubpassDependency subpassDependency {};
+    subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    subpassDependency.dstSubpass = 0;
+    subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    subpassDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    // Geladene Inhalte können von beliebiger Arbeit davor stammen, z.B. aus einem Shader gelesen worden sein
+    if (colorLoad || depthLoad) {
+        subpassDependency.srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        subpassDependency.srcAccessMask |= VK_ACCESS_MEMORY_WRITE_BIT;
+        subpassDependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    }
+
+    VkRenderPassCreateInfo renderPassCreateInfo {};
+    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassCreateInfo.pNext = nullptr;
+    renderPassCreateInfo.flags = 0;
+    renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachmentDescriptions.size());
+    renderPassCreateInfo.pAttachments = attachmentDescriptions.data();
+    renderPassCreateInfo.subpassCount = 1;
+    renderPassCreateInfo.pSubpasses = &subpassDescription;
+    renderPassCreateInfo.dependencyCount = 1;
+    renderPassCreateInfo.pDependencies = &subpassDependency;
+
+    VkRenderPass renderPass;
+    if (vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS) {
+        std::cerr << "RenderPass konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    stats.renderPassesCreated++;
+    return renderPass;
+}
+
+inline VkFramebuffer RenderPassCache::createFramebuffer(const FramebufferKey& key) {
+
+    VkFramebufferCreateInfo framebufferCreateInfo {};
+    framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferCreateInfo.renderPass = key.renderPass;
+    framebufferCreateInfo.attachmentCount = key.attachmentCount;
+    framebufferCreateInfo.pAttachments = key.attachments.data();
+    framebufferCreateInfo.width = key.width;
+    framebufferCreateInfo.height = key.height;
+    framebufferCreateInfo.layers = 1;
+
+    VkFramebuffer framebuffer;
+    if (vkCreateFramebuffer(device, &framebufferCreateInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+        std::cerr << "Framebuffer konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    stats.framebuffersCreated++;
+    return framebuffer;
+}
+
+inline void RenderPassCache::endFrame() {
+
+    frame++;
+
+    if (frame > maxUnusedFrames) {
+
+        const uint64_t oldestFrame = frame - maxUnusedFrames;
+
+        // Ein Framebuffer wird nie später benutzt als sein Render Pass, er ist also immer vorher dran
+        stats.framebuffersEvicted += framebuffers.evict(oldestFrame, [this](VkFramebuffer framebuffer) {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        });
+
+        stats.renderPassesEvicted += renderPasses.evict(oldestFrame, [this](VkRenderPass renderPass) {
+            vkDestroyRenderPass(device, renderPass, nullptr);
+        });
+    }
+
+    stats.renderPasses = renderPasses.size();
+    stats.framebuffers = framebuffers.size();
+}
+
+inline RenderPassCacheStats RenderPassCache::getStats() const {
+    return stats;
+}
+
+#endif //RENDER_PASS_CACHE_H
@@ -0,0 +1,208 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "CommandRecorder.h"
+
+struct DrawItem {
+    VkPipeline pipeline;
+    VkPipelineLayout pipelineLayout;
+    VkDescriptorSet descriptorSet;
+    VkBuffer vertexBuffer;
+    VkBuffer indexBuffer;
+    uint32_t indexCount;
+    VkShaderStageFlags pushConstantStages;
+    uint32_t pushConstantSize;
+    std::array<uint8_t, 128> pushConstants;
+};
+
+// Sortierschlüssel von oben nach unten: Pipeline (12 Bit), Descriptor Set (12 Bit),
+// Buffer (16 Bit), Tiefe (24 Bit). Teure Zustandswechsel landen dadurch in den
+// höchstwertigen Bits und werden beim Sortieren zusammengefasst. Überflüssige
+// Binds zwischen gleichen Zuständen lässt der CommandRecorder weg.
+// makeFrontToBackKey() zieht die Tiefe direkt hinter die Pipeline. Mit Depth Test werden
+// verdeckte Fragmente dann schon vom Early-Z verworfen, auf Kosten zusätzlicher Buffer-Binds.
+class RenderQueue {
+
+    private:
+        struct Entry {
+            uint64_t key;
+            uint32_t item;
+        };
+
+        std::vector<DrawItem> items;
+        std::vector<Entry> entries;
+        std::vector<Entry> scratch;
+
+    public:
+        static uint64_t makeKey(uint32_t pipelineId, uint32_t descriptorSetId, uint32_t bufferId, float depth);
+        static uint64_t makeFrontToBackKey(uint32_t pipelineId, uint32_t descriptorSetId, uint32_t bufferId, float depth);
+
+        void clear();
+
+        void submit(uint64_t key, const DrawItem& item);
+        template<typename T>
+        void submit(uint64_t key, DrawItem item, VkShaderStageFlags stages, const T& pushConstants);
+
+        void sort();
+        void record(CommandRecorder& recorder) const;
+        void record(CommandRecorder& recorder, uint32_t pipelineId) const;
+
+        // Zeichnet alle Draws mit depthPipeline statt ihrer eigenen Pipeline auf, z.B. für einen Depth Pre-Pass.
+        void recordDepthOnly(CommandRecorder& recorder, VkPipeline depthPipeline) const;
+
+        uint32_t size() const;
+
+    private:
+        static uint64_t quantizeDepth(float depth);
+        void recordEntry(CommandRecorder& recorder, const Entry& entry, VkPipeline pipeline = VK_NULL_HANDLE) const;
+};
+
+inline uint64_t RenderQueue::quantizeDepth(float depth) {
+
+    // Tiefe im Bereich [0, 1], vorne nach hinten aufsteigend
+    const float clampedDepth = std::clamp(depth, 0.0f, 1.0f);
+    return static_cast<uint64_t>(clampedDepth * static_cast<float>((1 << 24) - 1));
+}
+
+inline uint64_t RenderQueue::makeKey(uint32_t pipelineId, uint32_t descriptorSetId, uint32_t bufferId, float depth) {
+
+    return (static_cast<uint64_t>(pipelineId & 0xFFF) << 52) |
+           (static_cast<uint64_t>(descriptorSetId & 0xFFF) << 40) |
+           (static_cast<uint64_t>(bufferId & 0xFFFF) << 24) |
+           quantizeDepth(depth);
+}
+
+// Pipeline (12 Bit), Tiefe (24 Bit), Descriptor Set (12 Bit), Buffer (16 Bit). Die Pipeline
+// bleibt oben, damit record() mit pipelineId weiterhin funktioniert.
+inline uint64_t RenderQueue::makeFrontToBackKey(uint32_t pipelineId, uint32_t descriptorSetId, uint32_t bufferId, float depth) {
+
+    return (static_cast<uint64_t>(pipelineId & 0xFFF) << 52) |
+           (quantizeDepth(depth) << 28) |
+           (static_cast<uint64_t>(descriptorSetId & 0xFFF) << 16) |
+           static_cast<uint64_t>(bufferId & 0xFFFF);
+}
+
+inline void RenderQueue::clear() {
+    items.clear();
+    entries.clear();
+}
+
+inline void RenderQueue::submit(uint64_t key, const DrawItem& item) {
+    entries.push_back({ key, static_cast<uint32_t>(items.size()) });
+    items.push_back(item);
+}
+
+template<typename T>
+void RenderQueue::submit(uint64_t key, DrawItem item, VkShaderStageFlags stages, const T& pushConstants) {
+
+    static_assert(sizeof(T) <= sizeof(DrawItem::pushConstants), "Push Constants sind größer als 128 Byte");
+
+    item.pushConstantStages = stages;
+    item.pushConstantSize = sizeof(T);
+    std::memcpy(item.pushConstants.data(), &pushConstants, sizeof(T));
+
+    submit(key, item);
+}
+
+// LSD-Radixsort mit 8 Bit pro Durchlauf. Alle Histogramme entstehen in einem
+// einzigen Durchlauf, Stellen, in denen sich kein Schlüssel unterscheidet, werden übersprungen.
+inline void RenderQueue::sort() {
+
+    const size_t count = entries.size();
+    if (count < 2) {
+        return;
+    }
+
+    std::array<std::array<uint32_t, 256>, 8> histograms {};
+
+    for (const Entry& entry : entries) {
+        for (uint32_t pass = 0; pass < 8; pass++) {
+            histograms[pass][(entry.key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    scratch.resize(count);
+
+    for (uint32_t pass = 0; pass < 8; pass++) {
+
+        std::array<uint32_t, 256>& histogram = histograms[pass];
+
+        const uint8_t firstDigit = static_cast<uint8_t>((entries[0].key >> (pass * 8)) & 0xFF);
+        if (histogram[firstDigit] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            const uint32_t bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        for (const Entry& entry : entries) {
+            scratch[histogram[(entry.key >> (pass * 8)) & 0xFF]++] = entry;
+        }
+
+        entries.swap(scratch);
+    }
+}
+
+inline void RenderQueue::record(CommandRecorder& recorder) const {
+    for (const Entry& entry : entries) {
+        recordEntry(recorder, entry);
+    }
+}
+
+// Zeichnet nur die Draws einer Pipeline auf. Nach sort() liegen sie zusammenhängend im Schlüsselbereich.
+inline void RenderQueue::record(CommandRecorder& recorder, uint32_t pipelineId) const {
+
+    auto pipelineOf = [](const Entry& entry) {
+        return static_cast<uint32_t>(entry.key >> 52);
+    };
+
+    const auto first = std::partition_point(entries.begin(), entries.end(), [&](const Entry& entry) { return pipelineOf(entry) < pipelineId; });
+    const auto last = std::partition_point(first, entries.end(), [&](const Entry& entry) { return pipelineOf(entry) == pipelineId; });
+
+    for (auto entry = first; entry != last; ++entry) {
+        recordEntry(recorder, *entry);
+    }
+}
+
+inline void RenderQueue::recordDepthOnly(CommandRecorder& recorder, VkPipeline depthPipeline) const {
+    for (const Entry& entry : entries) {
+        recordEntry(recorder, entry, depthPipeline);
+    }
+}
+
+inline void RenderQueue::recordEntry(CommandRecorder& recorder, const Entry& entry, VkPipeline pipeline) const {
+
+    const DrawItem& item = items[entry.item];
+
+    recorder.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline != VK_NULL_HANDLE ? pipeline : item.pipeline);
+
+    if (item.descriptorSet != VK_NULL_HANDLE) {
+        recorder.bindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, item.pipelineLayout, 0, item.descriptorSet);
+    }
+
+    recorder.bindVertexBuffer(0, item.vertexBuffer);
+    recorder.bindIndexBuffer(item.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+    if (item.pushConstantSize > 0) {
+        recorder.pushConstants(item.pipelineLayout, item.pushConstantStages, 0, item.pushConstantSize, item.pushConstants.data());
+    }
+
+    recorder.drawIndexed(item.indexCount);
+}
+
+inline uint32_t RenderQueue::size() const {
+    return static_cast<uint32_t>(entries.size());
+}
+
+#endif //RENDER_QUEUE_H
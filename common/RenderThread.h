@@ -0,0 +1,164 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "CpuTrace.h"
+#include "SpscQueue.h"
+
+// Die Beispiele erzeugen die Swapchain nicht neu und werten keine Tasten aus, der Render Thread
+// braucht daher nur Minimieren und Wiederherstellen. Neue Event-Typen erst mit einem Empfänger.
+enum class InputEventType {
+    WindowMinimized,
+    WindowRestored
+};
+
+struct InputEvent {
+    InputEventType type;
+};
+
+// Übersetzt die für den Render Thread relevanten SDL-Events, alle anderen bleiben auf dem Hauptthread.
+inline std::optional<InputEvent> translateEvent(const SDL_Event& event) {
+
+    switch (event.type) {
+        case SDL_EVENT_WINDOW_MINIMIZED:
+            return InputEvent { InputEventType::WindowMinimized };
+        case SDL_EVENT_WINDOW_RESTORED:
+            return InputEvent { InputEventType::WindowRestored };
+        default:
+            return std::nullopt;
+    }
+}
+
+// Rendert auf einem eigenen Thread, während der Hauptthread die SDL-Events verarbeitet.
+// Events gehen über eine lock-freie SPSC-Warteschlange an den Render Thread, keiner der
+// beiden Threads wartet auf den anderen. Ist die Warteschlange voll, wird das Event verworfen.
+// Solange das Fenster minimiert ist, schläft der Render Thread bis zum nächsten Event.
+class RenderThread {
+
+    public:
+        static constexpr size_t EVENT_QUEUE_SIZE = 256;
+
+    private:
+        SpscQueue<InputEvent> events { EVENT_QUEUE_SIZE };
+
+        std::atomic<bool> running { false };
+        std::atomic<uint32_t> signal { 0 };
+        std::thread thread;
+
+        std::function<void()> renderFrame;
+        bool paused = false;
+
+        uint64_t droppedEvents = 0;
+        uint64_t renderedFrames = 0;
+
+    public:
+        RenderThread() = default;
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        void start(std::function<void()> renderFrame);
+
+        // Nur vom Hauptthread aufrufen.
+        void post(const InputEvent& event);
+
+        // Beendet den Render Thread nach dem aktuellen Frame.
+        void stop();
+
+        uint64_t getDroppedEvents() const;
+        uint64_t getRenderedFrames() const;
+
+    private:
+        void run();
+        void handleEvent(const InputEvent& event);
+};
+
+inline void RenderThread::start(std::function<void()> renderFrame) {
+
+    this->renderFrame = std::move(renderFrame);
+
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&RenderThread::run, this);
+}
+
+inline void RenderThread::post(const InputEvent& event) {
+
+    if (!events.push(event)) {
+        droppedEvents++;
+        return;
+    }
+
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+}
+
+inline void RenderThread::stop() {
+
+    if (!running.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    running.store(false, std::memory_order_release);
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+
+    thread.join();
+
+    if (droppedEvents > 0) {
+        std::cout << "Render Thread: " << droppedEvents << " Events verworfen" << std::endl;
+    }
+}
+
+inline uint64_t RenderThread::getDroppedEvents() const {
+    return droppedEvents;
+}
+
+inline uint64_t RenderThread::getRenderedFrames() const {
+    return renderedFrames;
+}
+
+inline void RenderThread::handleEvent(const InputEvent& event) {
+
+    switch (event.type) {
+        case InputEventType::WindowMinimized:
+            paused = true;
+            break;
+        case InputEventType::WindowRestored:
+            paused = false;
+            break;
+    }
+}
+
+inline void RenderThread::run() {
+
+    if (CpuTrace::isEnabled()) {
+        CpuTrace::setThreadName("Render");
+    }
+
+    while (running.load(std::memory_order_acquire)) {
+
+        const uint32_t seen = signal.load(std::memory_order_acquire);
+
+        while (const std::optional<InputEvent> event = events.pop()) {
+            handleEvent(*event);
+        }
+
+        // Minimiert gibt es keine Swapchain Images, bis zum nächsten Event schlafen
+        if (paused) {
+            signal.wait(seen, std::memory_order_acquire);
+            continue;
+        }
+
+        renderFrame();
+        renderedFrames++;
+    }
+}
+
+#endif //RENDER_THREAD_H
@@ -0,0 +1,346 @@
+#ifndef RENDERING_CONTEXT_H
+#define RENDERING_CONTEXT_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "BarrierBatch.h"
+#include "DeviceDispatch.h"
+#include "DeviceSelection.h"
+#include "RenderPassCache.h"
+
+struct RenderingOptions {
+    // Erzwingt Render Pass und Framebuffer, auch wenn Dynamic Rendering verfügbar ist
+    bool forceRenderPass = false;
+
+    // So viele Frames bleiben unbenutzte Render Passes und Framebuffer im Cache
+    uint32_t cacheFrames = 16;
+};
+
+inline RenderingOptions parseRenderingOptions(int argc, char* argv[]) {
+
+    RenderingOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--render-pass") == 0) {
+            options.forceRenderPass = true;
+        } else if (std::strcmp(argv[i], "--render-pass-cache-frames") == 0 && i + 1 < argc) {
+            options.cacheFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    return options;
+}
+
+// Alles, wovon eine Pipeline abhängt. Pipelines sind mit jedem Pass gleichen Layouts kompatibel.
+struct RenderingLayout {
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    // Mit samples > 1 gelten die Color Ops für das Multisample-Image, das Ergebnis wird immer aufgelöst und gespeichert
+    VkAttachmentLoadOp colorLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    VkAttachmentStoreOp colorStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+    VkAttachmentLoadOp depthLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    VkAttachmentStoreOp depthStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    // Layout des Ergebnisses nach dem Pass, beim Laden auch das Layout davor
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+};
+
+struct RenderingTargets {
+    VkExtent2D extent {};
+
+    // Ergebnis des Passes, z.B. das Swapchain Image
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView imageView = VK_NULL_HANDLE;
+
+    // Nur bei samples > 1: hierhin wird gerendert, am Ende des Passes wird nach image aufgelöst
+    VkImage multisampleImage = VK_NULL_HANDLE;
+    VkImageView multisampleImageView = VK_NULL_HANDLE;
+
+    // Nur bei depthFormat != VK_FORMAT_UNDEFINED
+    VkImage depthImage = VK_NULL_HANDLE;
+    VkImageView depthImageView = VK_NULL_HANDLE;
+
+    VkClearColorValue clearColor {{ 0.0f, 0.0f, 0.0f, 1.0f }};
+    float clearDepth = 1.0f;
+};
+
+// Beginnt und beendet einen Pass mit einem Color- und optional einem Depth-Attachment.
+// Mit Dynamic Rendering (Core ab 1.3, sonst VK_KHR_dynamic_rendering) gibt es weder Render
+// Pass noch Framebuffer. Ohne kommen Render Pass und Framebuffer bei Bedarf aus einem
+// RenderPassCache, wo sie nach einigen unbenutzten Frames wieder verworfen werden.
+class RenderingContext {
+
+    private:
+        VkDevice device = VK_NULL_HANDLE;
+        bool dynamicRendering = false;
+
+        RenderPassCache renderPassCache;
+
+        // Layout-Übergänge, die sonst der Render Pass erledigt
+        BarrierBatch barrierBatch;
+
+        // Für end()
+        RenderingLayout currentLayout;
+        VkImage currentImage = VK_NULL_HANDLE;
+
+    public:
+        // Vor vkCreateDevice aufrufen. Liefert true, wenn Dynamic Rendering benutzt werden kann. Dann
+        // ist features ausgefüllt und muss in die pNext-Kette von VkDeviceCreateInfo, vor 1.3 wird
+        // zusätzlich die Extension an deviceExtensions angehängt.
+        static bool enableDynamicRendering(const DeviceCapabilities& capabilities, const RenderingOptions& options, std::vector<const char*>& deviceExtensions, VkPhysicalDeviceDynamicRenderingFeaturesKHR& features);
+
+        // framesInFlight begrenzt cacheFrames nach unten, vorher darf nichts verworfen werden
+        void create(VkDevice device, bool dynamicRendering, uint32_t framesInFlight, const RenderingOptions& options);
+        void destroy();
+
+        bool usesDynamicRendering() const;
+
+        // Setzt je nach Weg den Render Pass oder hängt renderingCreateInfo an die pNext-Kette.
+        // layout und renderingCreateInfo müssen bis vkCreateGraphicsPipelines leben.
+        void preparePipeline(const RenderingLayout& layout, VkGraphicsPipelineCreateInfo& createInfo, VkPipelineRenderingCreateInfoKHR& renderingCreateInfo);
+
+        void begin(VkCommandBuffer commandBuffer, const RenderingLayout& layout, const RenderingTargets& targets);
+        void end(VkCommandBuffer commandBuffer);
+
+        // Einmal pro Frame nach dem letzten Pass aufrufen
+        void endFrame();
+
+        RenderPassCacheStats getCacheStats() const;
+
+    private:
+        static RenderPassKey toRenderPassKey(const RenderingLayout& layout);
+
+        void beginDynamicRendering(VkCommandBuffer commandBuffer, const RenderingLayout& layout, const RenderingTargets& targets);
+        void beginRenderPass(VkCommandBuffer commandBuffer, const RenderingLayout& layout, const RenderingTargets& targets);
+};
+
+inline bool RenderingContext::enableDynamicRendering(const DeviceCapabilities& capabilities, const RenderingOptions& options, std::vector<const char*>& deviceExtensions, VkPhysicalDeviceDynamicRenderingFeaturesKHR& features) {
+
+    if (options.forceRenderPass) {
+        return false;
+    }
+
+    const uint32_t apiVersion = capabilities.properties.apiVersion;
+    const bool core = VK_API_VERSION_MAJOR(apiVersion) > 1 || VK_API_VERSION_MINOR(apiVersion) >= 3;
+
+    // Bei der Geräteauswahl nur mit Vulkan 1.3 oder der Extension abgefragt, sonst bleibt es VK_FALSE
+    if (!capabilities.dynamicRenderingFeatures.dynamicRendering) {
+        return false;
+    }
+
+    features = capabilities.dynamicRenderingFeatures;
+    features.pNext = nullptr;
+
+    if (!core) {
+        deviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+
+    return true;
+}
+
+inline void RenderingContext::create(VkDevice device, bool dynamicRendering, uint32_t framesInFlight, const RenderingOptions& options) {
+
+    this->device = device;
+    this->dynamicRendering = dynamicRendering;
+
+    if (dynamicRendering && (deviceDispatch.vkCmdBeginRenderingKHR == nullptr || deviceDispatch.vkCmdEndRenderingKHR == nullptr)) {
+        std::cerr << "Dynamic Rendering ist aktiviert, aber vkCmdBeginRendering konnte nicht geladen werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    barrierBatch.create(false);
+    renderPassCache.create(device, std::max(options.cacheFrames, framesInFlight));
+}
+
+inline void RenderingContext::destroy() {
+    renderPassCache.destroy();
+}
+
+inline bool RenderingContext::usesDynamicRendering() const {
+    return dynamicRendering;
+}
+
+inline RenderPassKey RenderingContext::toRenderPassKey(const RenderingLayout& layout) {
+
+    RenderPassKey key {};
+    key.colorFormat = layout.colorFormat;
+    key.depthFormat = layout.depthFormat;
+    key.samples = layout.samples;
+    key.colorLoadOp = layout.colorLoadOp;
+    key.colorStoreOp = layout.colorStoreOp;
+    key.depthLoadOp = layout.depthLoadOp;
+    key.depthStoreOp = layout.depthStoreOp;
+    key.finalLayout = layout.finalLayout;
+
+    return key;
+}
+
+inline void RenderingContext::preparePipeline(const RenderingLayout& layout, VkGraphicsPipelineCreateInfo& createInfo, VkPipelineRenderingCreateInfoKHR& renderingCreateInfo) {
+
+    if (!dynamicRendering) {
+        createInfo.renderPass = renderPassCache.getRenderPass(toRenderPassKey(layout));
+        createInfo.subpass = 0;
+        return;
+    }
+
+    renderingCreateInfo = {};
+    renderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    renderingCreateInfo.pNext = createInfo.pNext;
+    renderingCreateInfo.viewMask = 0;
+    renderingCreateInfo.colorAttachmentCount = 1;
+    renderingCreateInfo.pColorAttachmentFormats = &layout.colorFormat;
+    renderingCreateInfo.depthAttachmentFormat = layout.depthFormat;
+    renderingCreateInfo.stencilAttachmentFormat = RenderPassCache::depthAspect(layout.depthFormat) & VK_IMAGE_ASPECT_STENCIL_BIT ? layout.depthFormat : VK_FORMAT_UNDEFINED;
+
+    createInfo.pNext = &renderingCreateInfo;
+    createInfo.renderPass = VK_NULL_HANDLE;
+    createInfo.subpass = 0;
+}
+
+inline void RenderingContext::begin(VkCommandBuffer commandBuffer, const RenderingLayout& layout, const RenderingTargets& targets) {
+
+    currentLayout = layout;
+    currentImage = targets.image;
+
+    if (dynamicRendering) {
+        beginDynamicRendering(commandBuffer, layout, targets);
+    } else {
+        beginRenderPass(commandBuffer, layout, targets);
+    }
+}
+
+inline void RenderingContext::beginRenderPass(VkCommandBuffer commandBuffer, const RenderingLayout& layout, const RenderingTargets& targets) {
+
+    const bool multisampled = layout.samples != VK_SAMPLE_COUNT_1_BIT;
+
+    FramebufferKey framebufferKey {};
+    framebufferKey.renderPass = renderPassCache.getRenderPass(toRenderPassKey(layout));
+    framebufferKey.attachments[framebufferKey.attachmentCount++] = multisampled ? targets.multisampleImageView : targets.imageView;
+    if (layout.depthFormat != VK_FORMAT_UNDEFINED) {
+        framebufferKey.attachments[framebufferKey.attachmentCount++] = targets.depthImageView;
+    }
+    if (multisampled) {
+        framebufferKey.attachments[framebufferKey.attachmentCount++] = targets.imageView;
+    }
+    framebufferKey.width = targets.extent.width;
+    framebufferKey.height = targets.extent.height;
+
+    // Gleiche Reihenfolge wie die Attachments, der Eintrag für das Resolve Attachment wird ignoriert
+    std::array<VkClearValue, 3> clearValues {};
+    clearValues[0].color = targets.clearColor;
+    clearValues[1].depthStencil = { targets.clearDepth, 0 };
+    clearValues[2].color = targets.clearColor;
+
+
+    VkRenderPassBeginInfo renderPassBeginInfo {};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = framebufferKey.renderPass;
+    renderPassBeginInfo.framebuffer = renderPassCache.getFramebuffer(framebufferKey);
+    renderPassBeginInfo.renderArea.offset = {0, 0};
+    renderPassBeginInfo.renderArea.extent = targets.extent;
+    renderPassBeginInfo.clearValueCount = framebufferKey.attachmentCount;
+    renderPassBeginInfo.pClearValues = clearValues.data();
+
+    deviceDispatch.vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+inline void RenderingContext::beginDynamicRendering(VkCommandBuffer commandBuffer, const RenderingLayout& layout, const RenderingTargets& targets) {
+
+    const bool multisampled = layout.samples != VK_SAMPLE_COUNT_1_BIT;
+    const bool depth = layout.depthFormat != VK_FORMAT_UNDEFINED;
+    const bool colorLoad = layout.colorLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+    const bool depthLoad = layout.depthLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+
+    // Ohne LOAD wird der Inhalt davor nicht gebraucht, also aus UNDEFINED. Geladene Inhalte können von beliebiger Arbeit davor stammen.
+    if (!multisampled && colorLoad) {
+        barrierBatch.imageTransition(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, layout.finalLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, targets.image);
+    } else {
+        barrierBatch.imageTransition(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, targets.image);
+    }
+
+    if (multisampled) {
+        barrierBatch.imageTransition(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, colorLoad ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, targets.multisampleImage);
+    }
+
+    if (depth) {
+        barrierBatch.imageTransition(VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, depthLoad ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, targets.depthImage, RenderPassCache::depthAspect(layout.depthFormat));
+    }
+
+    barrierBatch.flush(commandBuffer);
+
+    VkRenderingAttachmentInfoKHR colorAttachment {};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    colorAttachment.pNext = nullptr;
+    colorAttachment.imageView = multisampled ? targets.multisampleImageView : targets.imageView;
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.resolveMode = multisampled ? VK_RESOLVE_MODE_AVERAGE_BIT : VK_RESOLVE_MODE_NONE;
+    colorAttachment.resolveImageView = multisampled ? targets.imageView : VK_NULL_HANDLE;
+    colorAttachment.resolveImageLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.loadOp = layout.colorLoadOp;
+    colorAttachment.storeOp = layout.colorStoreOp;
+    colorAttachment.clearValue.color = targets.clearColor;
+
+    VkRenderingAttachmentInfoKHR depthAttachment {};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depthAttachment.pNext = nullptr;
+    depthAttachment.imageView = targets.depthImageView;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+    depthAttachment.loadOp = layout.depthLoadOp;
+    depthAttachment.storeOp = layout.depthStoreOp;
+    depthAttachment.clearValue.depthStencil = { targets.clearDepth, 0 };
+
+    VkRenderingInfoKHR renderingInfo {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.pNext = nullptr;
+    renderingInfo.flags = 0;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = targets.extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.viewMask = 0;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = depth ? &depthAttachment : nullptr;
+    renderingInfo.pStencilAttachment = depth && (RenderPassCache::depthAspect(layout.depthFormat) & VK_IMAGE_ASPECT_STENCIL_BIT) ? &depthAttachment : nullptr;
+
+    deviceDispatch.vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+}
+
+inline void RenderingContext::end(VkCommandBuffer commandBuffer) {
+
+    if (!dynamicRendering) {
+        deviceDispatch.vkCmdEndRenderPass(commandBuffer);
+        return;
+    }
+
+    deviceDispatch.vkCmdEndRenderingKHR(commandBuffer);
+
+    // Übernimmt den Übergang, den sonst finalLayout des Render Passes erledigt. Die Ziel-Stage
+    // ist dieselbe, damit nachfolgende Barrieren mit COLOR_ATTACHMENT_OUTPUT daran anschließen.
+    barrierBatch.imageTransition(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, currentLayout.finalLayout, currentImage);
+    barrierBatch.flush(commandBuffer);
+}
+
+inline void RenderingContext::endFrame() {
+
+    if (dynamicRendering) {
+        barrierBatch.endFrame();
+    } else {
+        renderPassCache.endFrame();
+    }
+}
+
+inline RenderPassCacheStats RenderingContext::getCacheStats() const {
+    return renderPassCache.getStats();
+}
+
+#endif //RENDERING_CONTEXT_H
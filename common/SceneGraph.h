@@ -0,0 +1,150 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Matrix.h"
+
+struct SceneGraphStats {
+    uint32_t nodesUpdated = 0;
+    uint32_t nodeCount = 0;
+};
+
+// Knoten liegen topologisch sortiert in flachen Arrays: ein Elternknoten hat
+// immer einen kleineren Index als seine Kinder. Ein einziger Durchlauf von
+// vorne nach hinten reicht daher, um alle Weltmatrizen zu aktualisieren.
+class SceneGraph {
+
+    public:
+        static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    private:
+        std::vector<uint32_t> parents;
+        std::vector<Matrix4f> localMatrices;
+        std::vector<Matrix4f> worldMatrices;
+        std::vector<uint8_t> dirty;
+
+        // Alles vor diesem Index ist sauber, update() beginnt erst hier.
+        uint32_t firstDirty = 0;
+
+        SceneGraphStats stats {};
+
+    public:
+        uint32_t addNode(uint32_t parent = NO_PARENT, const Matrix4f& local = Matrix4f());
+
+        void setLocal(uint32_t node, const Matrix4f& local);
+        Matrix4f& modifyLocal(uint32_t node);
+
+        const Matrix4f& getLocal(uint32_t node) const;
+        const Matrix4f& getWorld(uint32_t node) const;
+        uint32_t getParent(uint32_t node) const;
+
+        uint32_t size() const;
+
+        void update();
+
+        const SceneGraphStats& getStats() const;
+
+    private:
+        void markDirty(uint32_t node);
+};
+
+inline uint32_t SceneGraph::addNode(uint32_t parent, const Matrix4f& local) {
+
+    const auto node = static_cast<uint32_t>(parents.size());
+
+    if (parent != NO_PARENT && parent >= node) {
+        std::cerr << "Elternknoten " << parent << " existiert nicht!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    parents.push_back(parent);
+    localMatrices.push_back(local);
+    worldMatrices.emplace_back();
+    dirty.push_back(0);
+
+    markDirty(node);
+
+    return node;
+}
+
+inline void SceneGraph::markDirty(uint32_t node) {
+
+    dirty[node] = 1;
+
+    if (node < firstDirty) {
+        firstDirty = node;
+    }
+}
+
+inline void SceneGraph::setLocal(uint32_t node, const Matrix4f& local) {
+    localMatrices[node] = local;
+    markDirty(node);
+}
+
+inline Matrix4f& SceneGraph::modifyLocal(uint32_t node) {
+    markDirty(node);
+    return localMatrices[node];
+}
+
+inline const Matrix4f& SceneGraph::getLocal(uint32_t node) const {
+    return localMatrices[node];
+}
+
+inline const Matrix4f& SceneGraph::getWorld(uint32_t node) const {
+    return worldMatrices[node];
+}
+
+inline uint32_t SceneGraph::getParent(uint32_t node) const {
+    return parents[node];
+}
+
+inline uint32_t SceneGraph::size() const {
+    return static_cast<uint32_t>(parents.size());
+}
+
+inline void SceneGraph::update() {
+
+    const auto count = static_cast<uint32_t>(parents.size());
+
+    stats.nodesUpdated = 0;
+    stats.nodeCount = count;
+
+    // Ein Kind wird neu berechnet, wenn es selbst oder ein Vorfahre verändert wurde.
+    // Da Eltern vorher besucht werden, ist deren Flag an dieser Stelle bereits gesetzt.
+    for (uint32_t i = firstDirty; i < count; i++) {
+
+        const uint32_t parent = parents[i];
+
+        if (parent != NO_PARENT && dirty[parent]) {
+            dirty[i] = 1;
+        }
+
+        if (!dirty[i]) {
+            continue;
+        }
+
+        if (parent == NO_PARENT) {
+            worldMatrices[i] = localMatrices[i];
+        } else {
+            worldMatrices[i] = worldMatrices[parent] * localMatrices[i];
+        }
+
+        stats.nodesUpdated++;
+    }
+
+    for (uint32_t i = firstDirty; i < count; i++) {
+        dirty[i] = 0;
+    }
+
+    firstDirty = count;
+}
+
+inline const SceneGraphStats& SceneGraph::getStats() const {
+    return stats;
+}
+
+#endif //SCENE_GRAPH_H
@@ -0,0 +1,99 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Lock-freie Warteschlange für genau einen Produzenten- und einen Konsumenten-Thread.
+// Die Kapazität wird auf eine Zweierpotenz aufgerundet und ist danach fest, push()
+// schlägt bei voller Warteschlange fehl, statt zu blockieren.
+template<typename T>
+class SpscQueue {
+
+    private:
+        std::vector<T> slots;
+        size_t mask = 0;
+
+        // Getrennte Cache Lines, damit sich Produzent und Konsument nicht gegenseitig ausbremsen
+        alignas(64) std::atomic<size_t> head { 0 };
+        alignas(64) std::atomic<size_t> tail { 0 };
+
+    public:
+        explicit SpscQueue(size_t capacity);
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // Nur vom Produzenten aufrufen.
+        bool push(T value);
+
+        // Nur vom Konsumenten aufrufen.
+        std::optional<T> pop();
+
+        size_t capacity() const;
+        bool empty() const;
+};
+
+template<typename T>
+SpscQueue<T>::SpscQueue(size_t capacity) {
+
+    if (capacity == 0) {
+        std::cerr << "SpscQueue braucht eine Kapazität größer 0!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    slots.resize(size);
+    mask = size - 1;
+}
+
+template<typename T>
+bool SpscQueue<T>::push(T value) {
+
+    const size_t currentTail = tail.load(std::memory_order_relaxed);
+
+    if (currentTail - head.load(std::memory_order_acquire) == slots.size()) {
+        return false;
+    }
+
+    slots[currentTail & mask] = std::move(value);
+    tail.store(currentTail + 1, std::memory_order_release);
+
+    return true;
+}
+
+template<typename T>
+std::optional<T> SpscQueue<T>::pop() {
+
+    const size_t currentHead = head.load(std::memory_order_relaxed);
+
+    if (currentHead == tail.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+
+    std::optional<T> value(std::move(slots[currentHead & mask]));
+    head.store(currentHead + 1, std::memory_order_release);
+
+    return value;
+}
+
+template<typename T>
+size_t SpscQueue<T>::capacity() const {
+    return slots.size();
+}
+
+template<typename T>
+bool SpscQueue<T>::empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+#endif //SPSC_QUEUE_H
@@ -0,0 +1,1437 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_vulkan.h>
+#include <vulkan/vulkan.h>
+#include <iostream>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <queue>
+#include <span>
+
+#include "../../common/Benchmark.h"
+#include "../../common/DeviceDispatch.h"
+#include "../../common/DeviceSelection.h"
+#include "../../common/FrameCapture.h"
+#include "../../common/FrameTimeline.h"
+#include "../../common/Frustum.h"
+#include "../../common/GoldenImage.h"
+#include "../../common/GpuProfiler.h"
+#include "../../common/Headless.h"
+#include "../../common/Matrix.h"
+#include "../../common/MemoryTypes.h"
+#include "../../common/Readback.h"
+#include "../../common/RenderThread.h"
+#include "../../common/RenderingContext.h"
+#include "../../common/SceneGraph.h"
+
+const std::vector<const char*> validationLayers = {
+    "VK_LAYER_KHRONOS_validation"
+};
+
+#ifdef NDEBUG
+const bool enableValidationLayers = false;
+#else
+const bool enableValidationLayers = true;
+#endif
+
+uint32_t width = 800;
+uint32_t height = 600;
+
+const int MAX_FRAMES_IN_FLIGHT = 2;
+uint32_t currentFrame = 0;
+
+VkFormat swapChainImageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+
+SDL_Window* window;
+
+VkInstance instance;
+VkDebugUtilsMessengerEXT debugUtilsMessenger;
+VkSurfaceKHR surface;
+VkPhysicalDevice physicalDevice;
+DeviceCapabilities deviceCapabilities;
+MemoryTypeSelector memoryTypes;
+VkDevice device;
+uint32_t queueFamilyIndex;
+VkQueue graphicsQueue;
+VkSwapchainKHR swapchain;
+std::vector<VkImage> swapChainImages;
+std::vector<VkImageView> swapChainImageViews;
+VkDescriptorSetLayout descriptorSetLayout;
+VkDescriptorPool descriptorPool;
+VkPipelineLayout pipelineLayout;
+VkPipeline graphicsPipeline;
+VkPipelineLayout cullPipelineLayout;
+VkPipeline cullPipeline;
+std::vector<VkCommandPool> commandPools;
+std::vector<VkCommandBuffer> commandBuffers;
+std::vector<VkSemaphore> imageAvailableSemaphores;
+std::vector<VkSemaphore> renderFinishedSemaphores;
+FrameTimeline frameTimeline;
+
+uint32_t MAX_IMAGE_SIZE = 2;
+
+HeadlessOptions headlessOptions;
+OffscreenTargets offscreenTargets;
+FrameReadback frameReadback;
+
+GoldenImageOptions goldenImageOptions;
+GoldenImageTest goldenImageTest;
+
+CaptureOptions captureOptions;
+FrameCapture frameCapture;
+
+RenderingOptions renderingOptions;
+RenderingContext renderingContext;
+RenderingLayout renderingLayout;
+bool dynamicRenderingSupported = false;
+
+RenderThread renderThread;
+
+struct Frame {
+    VkCommandPool             commandPool;
+    VkCommandBuffer           commandBuffer;
+    VkSemaphore               waitSemaphore;
+    VkFence                   inFlightFence;
+};
+
+std::array<Frame, MAX_FRAMES_IN_FLIGHT> frames;
+
+template<typename T>
+struct vec2 {
+    T x, y;
+};
+
+using vec2f = vec2<float>;
+
+template<typename T>
+struct vec3 {
+    T x, y, z;
+};
+
+using vec3f = vec3<float>;
+
+struct Vertex {
+    vec2f position;
+    vec3f color;
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+
+        VkVertexInputBindingDescription vertexInputBindingDescription = {};
+        vertexInputBindingDescription.binding = 0;
+        vertexInputBindingDescription.stride = sizeof(Vertex);
+        vertexInputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return vertexInputBindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescription() {
+
+        std::array<VkVertexInputAttributeDescription, 2> vertexInputAttributeDescriptions = {};
+
+        vertexInputAttributeDescriptions[0].location = 0;
+        vertexInputAttributeDescriptions[0].binding = 0;
+        vertexInputAttributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+        vertexInputAttributeDescriptions[0].offset = offsetof(Vertex, position);
+
+        vertexInputAttributeDescriptions[1].location = 1;
+        vertexInputAttributeDescriptions[1].binding = 0;
+        vertexInputAttributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+        vertexInputAttributeDescriptions[1].offset = offsetof(Vertex, color);
+
+        return vertexInputAttributeDescriptions;
+    }
+};
+
+struct Buffer {
+
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+
+    void destroy(VkDevice device) const;
+};
+
+struct VertexBuffer : Buffer {
+    Bounds bounds;
+};
+
+using IndexBuffer = Buffer;
+
+void Buffer::destroy(VkDevice device) const {
+    memoryTypes.free(device, memory);
+    vkDestroyBuffer(device, buffer, nullptr);
+}
+
+VertexBuffer vertexBuffer = {};
+IndexBuffer indexBuffer = {};
+
+constexpr  std::array<Vertex, 4> vertices = {
+    Vertex {{-0.5, -0.5}, {1, 0, 0}},
+    Vertex {{0.5, -0.5}, {0, 1, 0}},
+    Vertex {{0.5, 0.5}, {0, 0, 1}},
+    Vertex {{-0.5, 0.5}, {0, 1, 1}}
+
+};
+
+constexpr std::array<uint32_t, 6> indices = {
+    0, 1, 2, 2, 3, 0
+};
+
+struct MeshPushConstant {
+    Matrix4f viewProjection;
+};
+
+MeshPushConstant meshPushConstant = {};
+
+struct CullPushConstant {
+    std::array<std::array<float, 4>, 6> planes;
+    uint32_t objectCount;
+    uint32_t indexCount;
+};
+
+// Entspricht ObjectData in triangle.vert und cull.comp (std430)
+struct ObjectData {
+    Matrix4f world;
+    std::array<float, 4> sphere;
+};
+
+struct CullingFrame {
+    Buffer objectBuffer;
+    Buffer drawCommandBuffer;
+    Buffer drawCountBuffer;
+    Buffer drawCountReadbackBuffer;
+    ObjectData* objects;
+    uint32_t* drawCountReadback;
+    VkDescriptorSet descriptorSet;
+    bool submitted;
+};
+
+std::array<CullingFrame, MAX_FRAMES_IN_FLIGHT> cullingFrames;
+
+constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+
+constexpr uint32_t GROUP_GRID_SIZE = 4;
+constexpr uint32_t LEAF_GRID_SIZE = 8;
+
+SceneGraph sceneGraph;
+std::vector<uint32_t> spinningGroups;
+std::vector<uint32_t> drawNodes;
+
+uint64_t sceneGraphFrames = 0;
+uint64_t sceneGraphNodesUpdated = 0;
+
+Matrix4f viewProjection;
+float cameraTime = 0.0f;
+
+uint64_t culledDraws = 0;
+uint64_t testedDraws = 0;
+
+GpuProfiler gpuProfiler;
+
+VkResult createDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) {
+    auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
+    if (func != nullptr) {
+        return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
+    } else {
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+    }
+}
+
+void destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT messenger, const VkAllocationCallbacks* pAllocator) {
+    auto func = (PFN_vkDestroyDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+    if (func != nullptr) {
+        func(instance, messenger, pAllocator);
+    } else {
+        std::cout << "vkDestroyDebugUtilsMessengerEXT konnte nicht ausgeführt werden" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
+    std::cerr << "Validation layer: " << pCallbackData->pMessage << std::endl;
+    return VK_FALSE;
+}
+
+void createInstance() {
+    uint32_t extensionCount = 0;
+    // Headless werden keine Surface-Erweiterungen benötigt, SDL ist dann nicht initialisiert
+    const char* const* extensions = headlessOptions.enabled ? nullptr : SDL_Vulkan_GetInstanceExtensions(&extensionCount);
+
+    std::vector<const char*> extensionList {};
+    extensionList.push_back("VK_EXT_debug_utils");
+
+    for (uint32_t x=0;x<extensionCount; x++) {
+        extensionList.push_back(extensions[x]);
+    }
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "Hello Vulkan";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "No Engine";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.apiVersion = VK_API_VERSION_1_3;
+
+    VkDebugUtilsMessengerCreateInfoEXT debugUtilsMessengerCreateInfo;
+    debugUtilsMessengerCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+    debugUtilsMessengerCreateInfo.pNext = nullptr;
+    debugUtilsMessengerCreateInfo.flags = 0;
+    debugUtilsMessengerCreateInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+    debugUtilsMessengerCreateInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT;
+    debugUtilsMessengerCreateInfo.pfnUserCallback = &debugCallback;
+    debugUtilsMessengerCreateInfo.pUserData = nullptr;
+
+    VkInstanceCreateInfo instanceCreateInfo {};
+    instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceCreateInfo.flags = 0;
+
+    if (enableValidationLayers) {
+        instanceCreateInfo.pNext = &debugUtilsMessengerCreateInfo;
+    }
+    instanceCreateInfo.pApplicationInfo = &appInfo;
+    instanceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(extensionList.size());
+    instanceCreateInfo.ppEnabledExtensionNames = extensionList.data();
+
+    if (enableValidationLayers) {
+        instanceCreateInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
+        instanceCreateInfo.ppEnabledLayerNames = validationLayers.data();
+    } else {
+        instanceCreateInfo.enabledLayerCount = 0;
+        instanceCreateInfo.ppEnabledLayerNames = nullptr;
+    }
+
+    if (vkCreateInstance(&instanceCreateInfo, nullptr, &instance) != VK_SUCCESS) {
+        std::cout << "Vulkan Instanz konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    createDebugUtilsMessengerEXT(instance, &debugUtilsMessengerCreateInfo, nullptr, &debugUtilsMessenger);
+}
+
+void createSurface() {
+
+    if (!SDL_Vulkan_CreateSurface(window, instance, nullptr, &surface)) {
+        std::cout << "Surface konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void pickPhysicalDevice() {
+
+    DeviceRequirements requirements {};
+    requirements.surface = headlessOptions.enabled ? VK_NULL_HANDLE : surface;
+
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        requirements.extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+    requirements.apiVersion = VK_API_VERSION_1_2;
+
+    // Indirect Count für die GPU-Liste, Timeline Semaphores für die Frame-Synchronisation
+    requirements.supports = [](const DeviceCapabilities& capabilities) {
+        return capabilities.features12.drawIndirectCount && capabilities.features12.timelineSemaphore && capabilities.features.drawIndirectFirstInstance;
+    };
+
+    deviceCapabilities = selectPhysicalDevice(instance, requirements);
+    physicalDevice = deviceCapabilities.physicalDevice;
+
+    const VkPhysicalDeviceProperties& deviceProperties = deviceCapabilities.properties;
+    std::cout << "GPU gewählt: " << deviceProperties.deviceName << std::endl;
+}
+
+void createDevice() {
+
+    std::vector<const char*> deviceExtensions;
+
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+
+    // Ohne Unterstützung bleibt es bei Render Pass und Framebuffer
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures {};
+    dynamicRenderingSupported = RenderingContext::enableDynamicRendering(deviceCapabilities, renderingOptions, deviceExtensions, dynamicRenderingFeatures);
+
+    // Mit Budget weicht die Speicherwahl auf andere Heaps aus, bevor der Treiber auslagern muss
+    const bool memoryBudgetEnabled = MemoryTypeSelector::enableMemoryBudget(deviceCapabilities, deviceExtensions);
+
+    // Bei der Auswahl geprüft, mit Surface auch für Present
+    const uint32_t graphicsFamily = deviceCapabilities.graphicsFamily;
+
+    float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueCreateInfo {};
+    queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueCreateInfo.queueFamilyIndex = graphicsFamily;
+    queueCreateInfo.queueCount = 1;
+    queueCreateInfo.pQueuePriorities = &queuePriority;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.pNext = dynamicRenderingSupported ? &dynamicRenderingFeatures : nullptr;
+    vulkan12Features.drawIndirectCount = VK_TRUE;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+
+    VkPhysicalDeviceFeatures deviceFeatures {};
+    deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+
+    VkDeviceCreateInfo deviceCreateInfo {};
+    deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceCreateInfo.pNext = &vulkan12Features;
+    deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+    deviceCreateInfo.queueCreateInfoCount = 1;
+    deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
+    deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+    if (vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &device) != VK_SUCCESS) {
+        std::cerr << "Logical Device konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    memoryTypes.create(physicalDevice, deviceCapabilities.memoryProperties, memoryBudgetEnabled);
+
+    vkGetDeviceQueue(device, graphicsFamily, 0, &graphicsQueue);
+    queueFamilyIndex = graphicsFamily;
+}
+
+void createSwapchain() {
+
+    VkSwapchainCreateInfoKHR swapchainCreateInfo {};
+    swapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    swapchainCreateInfo.surface = surface;
+    swapchainCreateInfo.minImageCount = MAX_IMAGE_SIZE;
+    swapchainCreateInfo.imageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+    swapchainCreateInfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+    swapchainCreateInfo.imageExtent = { width, height };
+    swapchainCreateInfo.imageArrayLayers = 1;
+    swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    // Für die Aufnahme wird aus den Swapchain Images zurückgelesen
+    if (captureOptions.isEnabled()) {
+        swapchainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    swapchainCreateInfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    swapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    swapchainCreateInfo.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    swapchainCreateInfo.clipped = VK_TRUE;
+
+    if (vkCreateSwapchainKHR(device, &swapchainCreateInfo, nullptr, &swapchain) != VK_SUCCESS) {
+        std::cerr << "Swapchain konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void createImageViews() {
+
+    uint32_t imageCount;
+    vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
+    swapChainImages.resize(imageCount);
+    vkGetSwapchainImagesKHR(device, swapchain, &imageCount, swapChainImages.data());
+
+    swapChainImageViews.resize(swapChainImages.size());
+
+    for (size_t i = 0; i < swapChainImages.size(); i++) {
+
+        VkImageViewCreateInfo imageViewCreateInfo {};
+
+        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCreateInfo.image = swapChainImages[i];
+        imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewCreateInfo.format = swapChainImageFormat;
+
+        imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+        imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &imageViewCreateInfo, nullptr, &swapChainImageViews[i]) != VK_SUCCESS) {
+            std::cerr << "Image View konnte nicht erstellt werden!" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void createOffscreenTargets() {
+
+    offscreenTargets.create(memoryTypes, device, swapChainImageFormat, { width, height }, MAX_FRAMES_IN_FLIGHT);
+
+    swapChainImages = offscreenTargets.getImages();
+    swapChainImageViews = offscreenTargets.getImageViews();
+}
+
+void createRenderingContext() {
+
+    renderingContext.create(device, dynamicRenderingSupported, MAX_FRAMES_IN_FLIGHT, renderingOptions);
+
+    renderingLayout.colorFormat = swapChainImageFormat;
+    renderingLayout.finalLayout = headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
+std::vector<char> readFile(const std::string& filename) {
+
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Shader-Datei konnte nicht geöffnet werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+
+    return buffer;
+}
+
+VkShaderModule createShaderModule(const std::vector<char>& code) {
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo {};
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = code.size();
+    shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule;
+
+    if (vkCreateShaderModule(device, &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        std::cout << "ShaderModule konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return shaderModule;
+}
+
+void createDescriptorSetLayout() {
+
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings {};
+
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[0].pImmutableSamplers = nullptr;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].pImmutableSamplers = nullptr;
+
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[2].pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo {};
+    descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorSetLayoutCreateInfo.pNext = nullptr;
+    descriptorSetLayoutCreateInfo.flags = 0;
+    descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    descriptorSetLayoutCreateInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        std::cout << "Descriptor Set Layout konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void createPipelineLayout() {
+
+    std::array<VkPushConstantRange, 1> pushConstantRanges = {};
+
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRanges[0].offset = 0;
+    pushConstantRanges[0].size = sizeof(MeshPushConstant);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint16_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        std::cout << "Pipeline Layout konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::array<VkPushConstantRange, 1> cullPushConstantRanges = {};
+
+    cullPushConstantRanges[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    cullPushConstantRanges[0].offset = 0;
+    cullPushConstantRanges[0].size = sizeof(CullPushConstant);
+
+    VkPipelineLayoutCreateInfo cullPipelineLayoutInfo{};
+    cullPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    cullPipelineLayoutInfo.setLayoutCount = 1;
+    cullPipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    cullPipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(cullPushConstantRanges.size());
+    cullPipelineLayoutInfo.pPushConstantRanges = cullPushConstantRanges.data();
+
+    if (vkCreatePipelineLayout(device, &cullPipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS) {
+        std::cout << "Compute Pipeline Layout konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void createGraphicsPipeline() {
+
+    auto vertShaderCode = readFile("shaders/triangle.vert.spv");
+    auto fragShaderCode = readFile("shaders/triangle.frag.spv");
+
+    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
+    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module = vertShaderModule;
+    vertShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragShaderStageInfo.module = fragShaderModule;
+    fragShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+
+    VkVertexInputBindingDescription vertexInputBindingDescription = Vertex::getBindingDescription();
+    std::array<VkVertexInputAttributeDescription, 2> vertexInputAttributeDescriptions = Vertex::getAttributeDescription();
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.pNext = nullptr;
+    vertexInputInfo.flags = 0;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &vertexInputBindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInputAttributeDescriptions.size());
+    vertexInputInfo.pVertexAttributeDescriptions = vertexInputAttributeDescriptions.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(width);
+    viewport.height = static_cast<float>(height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = {width, height};
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = &viewport;
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = &scissor;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {};
+    graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    graphicsPipelineCreateInfo.pNext = nullptr;
+    graphicsPipelineCreateInfo.stageCount = 2;
+    graphicsPipelineCreateInfo.pStages = shaderStages;
+    graphicsPipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+    graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssembly;
+    graphicsPipelineCreateInfo.pViewportState = &viewportState;
+    graphicsPipelineCreateInfo.pRasterizationState = &rasterizer;
+    graphicsPipelineCreateInfo.pMultisampleState = &multisampling;
+    graphicsPipelineCreateInfo.pColorBlendState = &colorBlending;
+    graphicsPipelineCreateInfo.layout = pipelineLayout;
+
+    VkPipelineRenderingCreateInfoKHR pipelineRenderingCreateInfo {};
+    renderingContext.preparePipeline(renderingLayout, graphicsPipelineCreateInfo, pipelineRenderingCreateInfo);
+
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+        std::cout << "Graphics Pipeline konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    vkDestroyShaderModule(device, vertShaderModule, nullptr);
+}
+
+void createComputePipeline() {
+
+    auto cullShaderCode = readFile("shaders/cull.comp.spv");
+
+    VkShaderModule cullShaderModule = createShaderModule(cullShaderCode);
+
+    VkPipelineShaderStageCreateInfo cullShaderStageInfo{};
+    cullShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    cullShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    cullShaderStageInfo.module = cullShaderModule;
+    cullShaderStageInfo.pName = "main";
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo {};
+    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCreateInfo.pNext = nullptr;
+    computePipelineCreateInfo.flags = 0;
+    computePipelineCreateInfo.stage = cullShaderStageInfo;
+    computePipelineCreateInfo.layout = cullPipelineLayout;
+    computePipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+    computePipelineCreateInfo.basePipelineIndex = -1;
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &cullPipeline) != VK_SUCCESS) {
+        std::cout << "Compute Pipeline konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vkDestroyShaderModule(device, cullShaderModule, nullptr);
+}
+
+void createCommandPool() {
+
+    commandPools.resize(swapChainImageViews.size());
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo {};
+    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+
+    for(uint32_t x = 0; x < commandPools.size(); x++) {
+        if (vkCreateCommandPool(device, &commandPoolCreateInfo, nullptr, &commandPools[x]) != VK_SUCCESS) {
+            std::cout << "Command Pool konnte nicht erstellt werden!" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void createCommandBuffers() {
+
+    commandBuffers.resize(swapChainImageViews.size());
+
+    for (size_t x=0; x < commandPools.size(); x++) {
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo {};
+        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferAllocateInfo.commandPool = commandPools[x];
+        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandBufferAllocateInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &commandBuffers[x]) != VK_SUCCESS) {
+            std::cerr << "Command Buffer konnte nicht allokiert werden!" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferredProperties = 0) {
+
+    VkBufferCreateInfo vertexBufferCreateInfo {};
+    vertexBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    vertexBufferCreateInfo.pNext = nullptr;
+    vertexBufferCreateInfo.flags = 0;
+    vertexBufferCreateInfo.size = size;
+    vertexBufferCreateInfo.usage = usage;
+    vertexBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    vertexBufferCreateInfo.queueFamilyIndexCount = 0;
+    vertexBufferCreateInfo.pQueueFamilyIndices = nullptr;
+
+    VkBuffer buffer {};
+    if (vkCreateBuffer(device, &vertexBufferCreateInfo, nullptr, &buffer) != VK_SUCCESS) {
+        std::cout << "Vertex Buffer konnte nicht erstellt werden" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+
+    VkDeviceMemory memory {};
+    if (memoryTypes.allocate(device, memoryRequirements, properties, preferredProperties, memory) != VK_SUCCESS) {
+        std::cout << "Memory konnte nicht reserviert werden" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    vkBindBufferMemory(device, buffer, memory, 0);
+
+    return { buffer, memory };
+}
+
+void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo {};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.pNext = nullptr;
+    commandBufferAllocateInfo.commandPool = commandPools[0];
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer {};
+    if (vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &commandBuffer) != VK_SUCCESS) {
+        std::cout << "CommandBuffer konnte nicht erstellt werden" << std::endl;
+        std::exit(EXIT_FAILURE);
+    };
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo {};
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.pNext = nullptr;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferBeginInfo.pInheritanceInfo = nullptr;
+
+    VkBufferCopy copyRegion {};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = size;
+
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+        std::cout << "CommandBuffer kann nicht aufzeichnen" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    deviceDispatch.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    deviceDispatch.vkEndCommandBuffer(commandBuffer);
+
+    // Der Upload bekommt einen eigenen Wert auf der Timeline, gewartet wird nur auf ihn statt auf die ganze Queue
+    const uint64_t uploadValue = frameTimeline.nextValue();
+    const VkSemaphore timelineSemaphore = frameTimeline.getSemaphore();
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.pNext = nullptr;
+    timelineSubmitInfo.waitSemaphoreValueCount = 0;
+    timelineSubmitInfo.pWaitSemaphoreValues = nullptr;
+    timelineSubmitInfo.signalSemaphoreValueCount = 1;
+    timelineSubmitInfo.pSignalSemaphoreValues = &uploadValue;
+
+    VkSubmitInfo submitInfo {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.waitSemaphoreCount =  0;
+    submitInfo.pWaitSemaphores = nullptr;
+    submitInfo.pWaitDstStageMask = nullptr;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timelineSemaphore;
+
+    if (deviceDispatch.vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        std::cout << "CommandBuffer konnte nicht übermittelt werden" << std::endl;
+        std::exit(EXIT_FAILURE);
+    };
+    benchmarkCounters.submits++;
+
+    frameTimeline.wait(uploadValue);
+    vkFreeCommandBuffers(device, commandPools[0], 1, &commandBuffer);
+}
+
+template<typename T>
+Buffer createDeviceLocalBuffer(std::span<const T> vertices, VkBufferUsageFlags usage) {
+
+    const VkDeviceSize size = vertices.size() * sizeof(T);
+
+    const Buffer stagingBuffer = createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    void* data;
+    vkMapMemory(device, stagingBuffer.memory, 0, size, 0, &data);
+    memcpy(data, vertices.data(), static_cast<size_t>(size));
+    vkUnmapMemory(device, stagingBuffer.memory);
+
+    const Buffer buffer = createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    copyBuffer(stagingBuffer.buffer, buffer.buffer, size);
+
+    stagingBuffer.destroy(device);
+
+    return buffer;
+}
+
+void createCullingFrames() {
+
+    const auto objectCount = static_cast<uint32_t>(drawNodes.size());
+
+    for (CullingFrame& frame : cullingFrames) {
+
+        frame.objectBuffer = createBuffer(objectCount * sizeof(ObjectData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frame.drawCommandBuffer = createBuffer(objectCount * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frame.drawCountBuffer = createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frame.drawCountReadbackBuffer = createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+
+        // Beide Host-Puffer bleiben dauerhaft gemappt
+        vkMapMemory(device, frame.objectBuffer.memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&frame.objects));
+        vkMapMemory(device, frame.drawCountReadbackBuffer.memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&frame.drawCountReadback));
+
+        frame.submitted = false;
+    }
+}
+
+void createDescriptorSets() {
+
+    std::array<VkDescriptorPoolSize, 1> poolSizes {};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = 3 * MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorPoolCreateInfo descriptorPoolCreateInfo {};
+    descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolCreateInfo.pNext = nullptr;
+    descriptorPoolCreateInfo.flags = 0;
+    descriptorPoolCreateInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+    descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    descriptorPoolCreateInfo.pPoolSizes = poolSizes.data();
+
+    if (vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        std::cout << "Descriptor Pool konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for (CullingFrame& frame : cullingFrames) {
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo {};
+        descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext = nullptr;
+        descriptorSetAllocateInfo.descriptorPool = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &descriptorSetLayout;
+
+        if (vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &frame.descriptorSet) != VK_SUCCESS) {
+            std::cout << "Descriptor Set konnte nicht allokiert werden!" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        std::array<VkDescriptorBufferInfo, 3> bufferInfos {};
+        bufferInfos[0] = { frame.objectBuffer.buffer, 0, VK_WHOLE_SIZE };
+        bufferInfos[1] = { frame.drawCommandBuffer.buffer, 0, VK_WHOLE_SIZE };
+        bufferInfos[2] = { frame.drawCountBuffer.buffer, 0, VK_WHOLE_SIZE };
+
+        std::array<VkWriteDescriptorSet, 3> writes {};
+        for (uint32_t i = 0; i < writes.size(); i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].pNext = nullptr;
+            writes[i].dstSet = frame.descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].dstArrayElement = 0;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+}
+
+VertexBuffer createVertexBuffer(std::span<const Vertex> vertices) {
+    return { createDeviceLocalBuffer(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT), computeBounds(vertices) };
+}
+
+IndexBuffer createIndexBuffer(std::span<const uint32_t> indices) {
+    return createDeviceLocalBuffer(indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+}
+
+void createScene() {
+
+    const uint32_t root = sceneGraph.addNode();
+
+    const float groupSpacing = 2.0f / GROUP_GRID_SIZE;
+    const float leafSpacing = groupSpacing / (LEAF_GRID_SIZE + 2);
+
+    for (uint32_t gy = 0; gy < GROUP_GRID_SIZE; gy++) {
+        for (uint32_t gx = 0; gx < GROUP_GRID_SIZE; gx++) {
+
+            Matrix4f groupLocal;
+            groupLocal.translate(-1.0f + (gx + 0.5f) * groupSpacing, -1.0f + (gy + 0.5f) * groupSpacing, 0.0f);
+
+            const uint32_t group = sceneGraph.addNode(root, groupLocal);
+
+            // Nur jede zweite Gruppe dreht sich, der Rest bleibt sauber und wird nicht neu berechnet
+            if ((gx + gy) % 2 == 0) {
+                spinningGroups.push_back(group);
+            }
+
+            for (uint32_t ly = 0; ly < LEAF_GRID_SIZE; ly++) {
+                for (uint32_t lx = 0; lx < LEAF_GRID_SIZE; lx++) {
+
+                    Matrix4f leafLocal;
+                    leafLocal.translate((lx - (LEAF_GRID_SIZE - 1) * 0.5f) * leafSpacing, (ly - (LEAF_GRID_SIZE - 1) * 0.5f) * leafSpacing, 0.0f);
+                    leafLocal.scale(leafSpacing * 0.8f, leafSpacing * 0.8f, 1.0f);
+
+                    drawNodes.push_back(sceneGraph.addNode(group, leafLocal));
+                }
+            }
+        }
+    }
+}
+
+void updateScene() {
+
+    for (uint32_t group : spinningGroups) {
+        sceneGraph.modifyLocal(group).rotate_z(0.01f);
+    }
+
+    sceneGraph.update();
+
+    sceneGraphFrames++;
+    sceneGraphNodesUpdated += sceneGraph.getStats().nodesUpdated;
+
+    // Kamera schwenkt seitlich, damit ein Teil des Gitters aus dem Bild läuft
+    cameraTime += 0.005f;
+    viewProjection.clear();
+    viewProjection.translate(std::sin(cameraTime), 0.0f, 0.0f);
+}
+
+// Wird erst nach dem Warten auf den Timeline-Wert des Frames aufgerufen, die GPU liest diesen Frame nicht mehr.
+void updateCullingFrame(CullingFrame& frame) {
+
+    const auto objectCount = static_cast<uint32_t>(drawNodes.size());
+
+    if (frame.submitted) {
+        testedDraws += objectCount;
+        culledDraws += objectCount - *frame.drawCountReadback;
+    }
+
+    const BoundingSphere& sphere = vertexBuffer.bounds.sphere;
+
+    for (uint32_t i = 0; i < objectCount; i++) {
+        frame.objects[i].world = sceneGraph.getWorld(drawNodes[i]);
+        frame.objects[i].sphere = { sphere.center[0], sphere.center[1], sphere.center[2], sphere.radius };
+    }
+
+    frame.submitted = true;
+}
+
+void recordCulling(VkCommandBuffer commandBuffer, const CullingFrame& frame) {
+
+    GpuScope scope(gpuProfiler, "Culling");
+
+    const auto objectCount = static_cast<uint32_t>(drawNodes.size());
+
+    deviceDispatch.vkCmdFillBuffer(commandBuffer, frame.drawCountBuffer.buffer, 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier fillBarrier {};
+    fillBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    fillBarrier.pNext = nullptr;
+    fillBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    fillBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    deviceDispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &fillBarrier, 0, nullptr, 0, nullptr);
+
+    CullPushConstant cullPushConstant {};
+    cullPushConstant.planes = extractFrustum(viewProjection).planes;
+    cullPushConstant.objectCount = objectCount;
+    cullPushConstant.indexCount = static_cast<uint32_t>(indices.size());
+
+    deviceDispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    deviceDispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+    deviceDispatch.vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstant), &cullPushConstant);
+    deviceDispatch.vkCmdDispatch(commandBuffer, (objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+    // Kompaktierte Draw-Liste und Zähler müssen vor dem indirekten Draw sichtbar sein
+    VkMemoryBarrier cullBarrier {};
+    cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.pNext = nullptr;
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    deviceDispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copyRegion {};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = sizeof(uint32_t);
+
+    deviceDispatch.vkCmdCopyBuffer(commandBuffer, frame.drawCountBuffer.buffer, frame.drawCountReadbackBuffer.buffer, 1, &copyRegion);
+
+    VkMemoryBarrier readbackBarrier {};
+    readbackBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    readbackBarrier.pNext = nullptr;
+    readbackBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    readbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    deviceDispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &readbackBarrier, 0, nullptr, 0, nullptr);
+}
+
+void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo {};
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+        std::cout << "Commandbuffer konnte nicht beginnen!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    gpuProfiler.beginFrame(commandBuffer, currentFrame);
+    gpuProfiler.beginScope("Frame");
+
+    const CullingFrame& frame = cullingFrames[currentFrame];
+
+    recordCulling(commandBuffer, frame);
+
+    RenderingTargets renderingTargets {};
+    renderingTargets.extent = {width, height};
+    renderingTargets.image = swapChainImages[imageIndex];
+    renderingTargets.imageView = swapChainImageViews[imageIndex];
+
+    VkBuffer vertexBuffers[] = {vertexBuffer.buffer};
+    VkDeviceSize offsets[] = {0};
+
+    gpuProfiler.beginScope("Render Pass");
+    renderingContext.begin(commandBuffer, renderingLayout, renderingTargets);
+    deviceDispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    deviceDispatch.vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    deviceDispatch.vkCmdBindIndexBuffer(commandBuffer, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    deviceDispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+
+    meshPushConstant.viewProjection = viewProjection;
+    deviceDispatch.vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstant), &meshPushConstant);
+
+    // firstInstance trägt den Objektindex, den der Vertex Shader über gl_InstanceIndex liest
+    deviceDispatch.vkCmdDrawIndexedIndirectCount(commandBuffer, frame.drawCommandBuffer.buffer, 0, frame.drawCountBuffer.buffer, 0, static_cast<uint32_t>(drawNodes.size()), sizeof(VkDrawIndexedIndirectCommand));
+
+    renderingContext.end(commandBuffer);
+    renderingContext.endFrame();
+    gpuProfiler.endScope();
+
+    gpuProfiler.endScope();
+
+    frameReadback.record(commandBuffer, currentFrame, swapChainImages[imageIndex], headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    if (deviceDispatch.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        std::cerr << "Command Buffer konnte nicht aufgezeichnet werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void createSyncObjects() {
+
+    // Ein Timeline Semaphore ersetzt die Fences aller Frames
+    frameTimeline.create(device, MAX_FRAMES_IN_FLIGHT);
+
+    // Die Präsentation kann nur mit binären Semaphoren synchronisiert werden
+    if (headlessOptions.enabled) {
+        return;
+    }
+
+    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
+            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
+            std::cerr << "Synchronisationsobjekte konnten nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+            }
+    }
+}
+
+void drawFrame() {
+
+    frameTimeline.waitForFrame(currentFrame);
+
+    frameReadback.collect(currentFrame);
+
+    // Headless gehört das Offscreen Image fest zum Frame
+    uint32_t imageIndex = currentFrame;
+    if (!headlessOptions.enabled) {
+        deviceDispatch.vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    }
+
+    updateCullingFrame(cullingFrames[currentFrame]);
+
+    deviceDispatch.vkResetCommandPool(device, commandPools[currentFrame], 0);
+    recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+    // Signalisiert wird der Timeline-Wert des Frames und, mit Fenster, der binäre Semaphore für die Präsentation.
+    // Der Wert für den binären Semaphore wird ignoriert.
+    const uint64_t frameValue = frameTimeline.beginFrame(currentFrame);
+
+    const uint32_t signalCount = headlessOptions.enabled ? 1 : 2;
+    VkSemaphore signalSemaphores[] = { frameTimeline.getSemaphore(), VK_NULL_HANDLE };
+    uint64_t signalValues[] = { frameValue, 0 };
+    if (!headlessOptions.enabled) {
+        signalSemaphores[1] = renderFinishedSemaphores[currentFrame];
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.pNext = nullptr;
+    timelineSubmitInfo.waitSemaphoreValueCount = 0;
+    timelineSubmitInfo.pWaitSemaphoreValues = nullptr;
+    timelineSubmitInfo.signalSemaphoreValueCount = signalCount;
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.waitSemaphoreCount = headlessOptions.enabled ? 0 : 1;
+    submitInfo.pWaitSemaphores = headlessOptions.enabled ? nullptr : &imageAvailableSemaphores[currentFrame];
+    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+    submitInfo.signalSemaphoreCount = signalCount;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+
+    if (deviceDispatch.vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        std::cerr << "Queue Submit fehlgeschlagen!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    benchmarkCounters.submits++;
+
+    if (!headlessOptions.enabled) {
+        VkPresentInfoKHR presentInfo {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &renderFinishedSemaphores[currentFrame];;
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swapchain;
+        presentInfo.pImageIndices = &imageIndex;
+
+        deviceDispatch.vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    }
+
+    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+
+void cleanup() {
+
+    vertexBuffer.destroy(device);
+    indexBuffer.destroy(device);
+
+    for (CullingFrame& frame : cullingFrames) {
+        vkUnmapMemory(device, frame.objectBuffer.memory);
+        vkUnmapMemory(device, frame.drawCountReadbackBuffer.memory);
+
+        frame.objectBuffer.destroy(device);
+        frame.drawCommandBuffer.destroy(device);
+        frame.drawCountBuffer.destroy(device);
+        frame.drawCountReadbackBuffer.destroy(device);
+    }
+
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+
+    for (size_t i = 0; i < imageAvailableSemaphores.size(); i++) {
+        vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
+        vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
+    }
+
+    frameTimeline.destroy();
+
+    for (auto &commandPool : commandPools) {
+        vkDestroyCommandPool(device, commandPool, nullptr);
+    }
+
+    vkDestroyPipeline(device, cullPipeline, nullptr);
+    vkDestroyPipelineLayout(device, cullPipelineLayout, nullptr);
+    vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+
+    renderingContext.destroy();
+
+    if (headlessOptions.enabled) {
+        offscreenTargets.destroy(device);
+    } else {
+        for (auto imageView : swapChainImageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(device, swapchain, nullptr);
+    }
+
+    frameReadback.destroy();
+    gpuProfiler.destroy();
+
+    vkDestroyDevice(device, nullptr);
+    if (!headlessOptions.enabled) {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
+
+    destroyDebugUtilsMessengerEXT(instance, debugUtilsMessenger, nullptr);
+
+    vkDestroyInstance(instance, nullptr);
+}
+
+void renderFrame() {
+    updateScene();
+    drawFrame();
+}
+
+int main(int argc, char* argv[]) {
+
+    headlessOptions = parseHeadlessOptions(argc, argv);
+    goldenImageOptions = parseGoldenImageOptions(argc, argv);
+    captureOptions = parseCaptureOptions(argc, argv);
+    renderingOptions = parseRenderingOptions(argc, argv);
+
+    // Referenzbilder werden immer ohne Fenster gerendert
+    if (goldenImageOptions.isEnabled()) {
+        headlessOptions.enabled = true;
+    }
+
+    if (!headlessOptions.enabled) {
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            std::cout << "SDL konnte nicht initialisiert werden: " << SDL_GetError() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+
+        SDL_PropertiesID properties = SDL_CreateProperties();
+        SDL_SetStringProperty(properties, SDL_PROP_WINDOW_CREATE_TITLE_STRING, "Hello Vulkan SDL3");
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, 800);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, 600);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
+        window = SDL_CreateWindowWithProperties(properties);
+        SDL_DestroyProperties(properties);
+
+        if (!window) {
+            std::cout << "Fenster konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
+            SDL_Quit();
+            return EXIT_FAILURE;
+        }
+    }
+
+    createInstance();
+    if (!headlessOptions.enabled) {
+        createSurface();
+    }
+    pickPhysicalDevice();
+    createDevice();
+    deviceDispatch.load(device);
+    gpuProfiler.create(deviceCapabilities, device, queueFamilyIndex, MAX_FRAMES_IN_FLIGHT);
+    if (headlessOptions.enabled) {
+        createOffscreenTargets();
+    } else {
+        createSwapchain();
+        createImageViews();
+    }
+    createRenderingContext();
+    createDescriptorSetLayout();
+    createPipelineLayout();
+    createGraphicsPipeline();
+    createComputePipeline();
+    createCommandPool();
+    createCommandBuffers();
+    createSyncObjects();
+
+    vertexBuffer = createVertexBuffer(vertices);
+    indexBuffer = createIndexBuffer(indices);
+
+    createScene();
+    createCullingFrames();
+    createDescriptorSets();
+
+    if (goldenImageOptions.isEnabled() || captureOptions.isEnabled()) {
+        frameReadback.create(memoryTypes, device, { width, height }, swapChainImageFormat, MAX_FRAMES_IN_FLIGHT, [](const ReadbackFrame& frame) {
+            if (goldenImageOptions.isEnabled()) {
+                goldenImageTest.capture(frame);
+            }
+            frameCapture.push(frame);
+        });
+    }
+
+    if (captureOptions.isEnabled()) {
+        frameCapture.start(captureOptions, width, height, swapChainImageFormat);
+    }
+
+    if (!headlessOptions.benchmarkPath.empty()) {
+        runBenchmark("compute_culling", device, headlessOptions, gpuProfiler, memoryTypes, renderFrame);
+    } else if (headlessOptions.enabled) {
+        runHeadless(device, headlessOptions.frameCount, renderFrame);
+    } else {
+        SDL_ShowWindow(window);
+
+        // Der Hauptthread verarbeitet nur noch Events, gerendert wird auf dem Render Thread
+        renderThread.start(renderFrame);
+
+        bool running = true;
+        SDL_Event event;
+
+        while (running && SDL_WaitEvent(&event)) {
+            if (event.type == SDL_EVENT_QUIT) {
+                running = false;
+            } else if (const std::optional<InputEvent> inputEvent = translateEvent(event)) {
+                renderThread.post(*inputEvent);
+            }
+        }
+
+        renderThread.stop();
+    }
+
+    // Die letzten Frames in Flight sind noch nicht ausgelesen
+    vkDeviceWaitIdle(device);
+    gpuProfiler.flush();
+
+    int exitCode = EXIT_SUCCESS;
+    if (frameReadback.isEnabled()) {
+        vkDeviceWaitIdle(device);
+        frameReadback.flush();
+        frameCapture.stop();
+
+        if (goldenImageOptions.isEnabled()) {
+            exitCode = goldenImageTest.finish(goldenImageOptions);
+        }
+    }
+
+    if (sceneGraphFrames > 0) {
+        std::cout << "Szenengraph: durchschnittlich " << sceneGraphNodesUpdated / sceneGraphFrames << " von " << sceneGraph.size() << " Knoten pro Frame aktualisiert" << std::endl;
+        std::cout << "GPU Culling: durchschnittlich " << culledDraws / sceneGraphFrames << " von " << testedDraws / sceneGraphFrames << " Draws pro Frame verworfen" << std::endl;
+    }
+
+    std::cout << "Timeline: " << frameTimeline.getFrameSubmits() << " Frame-Submits (" << frameTimeline.getLastValue() << " Signale mit Uploads), " << frameTimeline.getHostWaits() << " Werte mussten auf dem Host abgewartet werden" << std::endl;
+
+    for (const GpuScopeStats& scope : gpuProfiler.getStats()) {
+        std::cout << "GPU " << scope.name << ": min " << scope.minMs << " ms, avg " << scope.avgMs << " ms, p99 " << scope.p99Ms << " ms (" << scope.samples << " Frames)" << std::endl;
+    }
+
+    const RenderPassCacheStats cacheStats = renderingContext.getCacheStats();
+    std::cout << "Rendering: " << (renderingContext.usesDynamicRendering() ? "Dynamic Rendering" : "Render Pass") << ", " << cacheStats.renderPassesCreated << " Render Passes und " << cacheStats.framebuffersCreated << " Framebuffer erstellt, " << cacheStats.renderPassesEvicted + cacheStats.framebuffersEvicted << " verworfen, " << cacheStats.hits << " Treffer im Cache" << std::endl;
+
+    const MemoryTypeStats memoryStats = memoryTypes.getStats();
+    std::cout << "Speicher: " << memoryStats.allocations << " Allokationen, " << memoryStats.fallbacks << " davon ausgewichen, Budget " << (memoryStats.budgetSupported ? "über VK_EXT_memory_budget" : "geschätzt") << std::endl;
+
+    if (!headlessOptions.enabled) {
+        SDL_HideWindow(window);
+    }
+
+    vkDeviceWaitIdle(device);
+    cleanup();
+
+    if (!headlessOptions.enabled) {
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+    }
+
+    return exitCode;
+}
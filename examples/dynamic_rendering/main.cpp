@@ -6,6 +6,19 @@
 #include <array>
 #include <fstream>
 
+#include "../../common/BarrierBatch.h"
+#include "../../common/Benchmark.h"
+#include "../../common/DeviceDispatch.h"
+#include "../../common/DeviceSelection.h"
+#include "../../common/FrameCapture.h"
+#include "../../common/GoldenImage.h"
+#include "../../common/GpuProfiler.h"
+#include "../../common/Headless.h"
+#include "../../common/MemoryTypes.h"
+#include "../../common/Readback.h"
+#include "../../common/RenderGraph.h"
+#include "../../common/RenderThread.h"
+
 const std::vector<const char*> validationLayers = {
     "VK_LAYER_KHRONOS_validation"
 };
@@ -30,6 +43,8 @@ VkInstance instance;
 VkDebugUtilsMessengerEXT debugUtilsMessenger;
 VkSurfaceKHR surface;
 VkPhysicalDevice physicalDevice;
+DeviceCapabilities deviceCapabilities;
+MemoryTypeSelector memoryTypes;
 VkDevice device;
 VkQueue graphicsQueue;
 VkSwapchainKHR swapchain;
@@ -37,6 +52,14 @@ std::vector<VkImage> swapChainImages;
 std::vector<VkImageView> swapChainImageViews;
 VkPipelineLayout pipelineLayout;
 VkPipeline graphicsPipeline;
+
+// Nachbearbeitung: Vollbild-Passes, die das Ergebnis des vorherigen Passes samplen
+VkDescriptorSetLayout postDescriptorSetLayout;
+VkPipelineLayout postPipelineLayout;
+VkPipeline blurPipeline;
+VkPipeline compositePipeline;
+VkSampler postSampler;
+VkDescriptorPool descriptorPool;
 VkCommandPool commandPool;
 std::vector<VkCommandBuffer> commandBuffers;
 std::vector<VkSemaphore> imageAvailableSemaphores;
@@ -45,6 +68,40 @@ std::vector<VkFence> inFlightFences;
 
 uint32_t MAX_IMAGE_SIZE = 2;
 
+HeadlessOptions headlessOptions;
+OffscreenTargets offscreenTargets;
+FrameReadback frameReadback;
+
+GoldenImageOptions goldenImageOptions;
+GoldenImageTest goldenImageTest;
+
+CaptureOptions captureOptions;
+FrameCapture frameCapture;
+
+RenderThread renderThread;
+
+uint32_t queueFamilyIndex;
+GpuProfiler gpuProfiler;
+
+bool synchronization2Supported = false;
+RenderGraph renderGraph;
+RenderResource backbuffer;
+
+// Szene -> Blur horizontal -> Blur vertikal -> Composite. Mit --no-blur liest Composite direkt
+// die Szene, die Blur-Passes stehen trotzdem im Graphen und werden von compile() verworfen.
+bool blurEnabled = true;
+bool printRenderGraph = false;
+RenderResource sceneColor;
+RenderResource blurHorizontal;
+RenderResource blurVertical;
+VkDescriptorSet sceneDescriptorSet = VK_NULL_HANDLE;
+VkDescriptorSet blurHorizontalDescriptorSet = VK_NULL_HANDLE;
+VkDescriptorSet blurVerticalDescriptorSet = VK_NULL_HANDLE;
+
+// Über --msaa angefordert, wird in pickPhysicalDevice auf das vom Gerät Unterstützte begrenzt
+uint32_t requestedSamples = 1;
+VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+
 VkResult createDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) {
     auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
     if (func != nullptr) {
@@ -64,58 +121,15 @@ void destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT
     }
 }
 
-void vkCmdBeginRenderingKHR(VkCommandBuffer commandBuffer, VkRenderingInfo *pRenderingInfo) {
-    auto func = (PFN_vkCmdBeginRenderingKHR) vkGetInstanceProcAddr(instance, "vkCmdBeginRenderingKHR");
-    if (func != nullptr) {
-        func(commandBuffer, pRenderingInfo);
-    } else {
-        std::cout << "vkCmdBeginRenderingKHR konnte nicht ausgeführt werden" << std::endl;
-        std::exit(EXIT_FAILURE);
-    }
-}
-
-void vkCmdEndRenderingKHR(VkCommandBuffer commandBuffer) {
-    auto func = (PFN_vkCmdEndRendering) vkGetInstanceProcAddr(instance, "vkCmdEndRenderingKHR");
-    if (func != nullptr) {
-        func(commandBuffer);
-    } else {
-        std::cout << "vkCmdEndRendering konnte nicht ausgeführt werden" << std::endl;
-        std::exit(EXIT_FAILURE);
-    }
-}
-
 VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
     std::cerr << "Validation layer: " << pCallbackData->pMessage << std::endl;
     return VK_FALSE;
 }
 
-void imageLayoutTransition(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,  VkImageLayout oldLayout, VkImageLayout newLayout, VkImage image) {
-
-    VkImageSubresourceRange imageSubresourceRange {};
-    imageSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    imageSubresourceRange.baseMipLevel = 0;
-    imageSubresourceRange.levelCount = 1;
-    imageSubresourceRange.baseArrayLayer = 0;
-    imageSubresourceRange.layerCount = 1;
-
-    std::array<VkImageMemoryBarrier, 1> imageMemoryBarriers {};
-    imageMemoryBarriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    imageMemoryBarriers[0].pNext = nullptr;
-    imageMemoryBarriers[0].srcAccessMask = srcAccessMask;
-    imageMemoryBarriers[0].dstAccessMask = dstAccessMask;
-    imageMemoryBarriers[0].oldLayout = oldLayout;
-    imageMemoryBarriers[0].newLayout = newLayout;
-    imageMemoryBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    imageMemoryBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    imageMemoryBarriers[0].image = image;
-    imageMemoryBarriers[0].subresourceRange = imageSubresourceRange;
-
-    vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, VK_DEPENDENCY_BY_REGION_BIT, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageMemoryBarriers.size()), imageMemoryBarriers.data());
-}
-
 void createInstance() {
     uint32_t extensionCount = 0;
-    const char* const* extensions = SDL_Vulkan_GetInstanceExtensions(&extensionCount);
+    // Headless werden keine Surface-Erweiterungen benötigt, SDL ist dann nicht initialisiert
+    const char* const* extensions = headlessOptions.enabled ? nullptr : SDL_Vulkan_GetInstanceExtensions(&extensionCount);
 
     std::vector<const char*> extensionList {};
     extensionList.push_back("VK_EXT_debug_utils");
@@ -178,53 +192,61 @@ void createSurface() {
 
 void pickPhysicalDevice() {
 
-    uint32_t deviceCount = 0;
-    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    DeviceRequirements requirements {};
+    requirements.surface = headlessOptions.enabled ? VK_NULL_HANDLE : surface;
 
-    if (deviceCount == 0) {
-        std::cout << "Keine Grafikkarte mit Vulkan-Unterstützung gefunden!" << std::endl;
-        exit(EXIT_FAILURE);
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        requirements.extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
+    requirements.extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
 
-    std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    deviceCapabilities = selectPhysicalDevice(instance, requirements);
+    physicalDevice = deviceCapabilities.physicalDevice;
 
-    physicalDevice = devices[0];
+    const VkPhysicalDeviceProperties& deviceProperties = deviceCapabilities.properties;
+    std::cout << "GPU gewählt: " << deviceProperties.deviceName << std::endl;
 
-    VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
-    std::cout << "GPU gefunden: " << deviceProperties.deviceName << std::endl;
+    // Höchste unterstützte Anzahl Samples, die nicht über der angeforderten liegt
+    for (uint32_t count = 2; count <= requestedSamples && count <= VK_SAMPLE_COUNT_64_BIT; count *= 2) {
+        if (deviceProperties.limits.framebufferColorSampleCounts & count) {
+            msaaSamples = static_cast<VkSampleCountFlagBits>(count);
+        }
+    }
 }
 
 void createDevice() {
 
-    const std::vector<const char*> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+    std::vector<const char*> deviceExtensions = {
         VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
     };
 
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+
+    // Erlaubt es, alle Layout-Übergänge eines Pass-Wechsels mit einem Aufruf abzusetzen
+    if (deviceCapabilities.hasExtension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+        deviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+        synchronization2Supported = true;
+    }
+
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    synchronization2Features.pNext = nullptr;
+    synchronization2Features.synchronization2 = VK_TRUE;
+
     VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
     dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
-    dynamicRenderingFeatures.pNext = nullptr;
+    dynamicRenderingFeatures.pNext = synchronization2Supported ? &synchronization2Features : nullptr;
     dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
 
-    uint32_t queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
-
-    int graphicsFamily = -1;
-    for (int i = 0; i < queueFamilyCount; i++) {
-        if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            graphicsFamily = i;
-            break;
-        }
-    }
+    // Mit Budget weicht die Speicherwahl auf andere Heaps aus, bevor der Treiber auslagern muss
+    const bool memoryBudgetEnabled = MemoryTypeSelector::enableMemoryBudget(deviceCapabilities, deviceExtensions);
 
-    if (graphicsFamily == -1) {
-        std::cout << "Keine passende Queue Family gefunden!" << std::endl;
-        exit(EXIT_FAILURE);
-    }
+    // Bei der Auswahl geprüft, mit Surface auch für Present
+    const uint32_t graphicsFamily = deviceCapabilities.graphicsFamily;
 
     float queuePriority = 1.0f;
     VkDeviceQueueCreateInfo queueCreateInfo {};
@@ -250,7 +272,11 @@ void createDevice() {
         exit(EXIT_FAILURE);
     }
 
+    memoryTypes.create(physicalDevice, deviceCapabilities.memoryProperties, memoryBudgetEnabled);
+
     vkGetDeviceQueue(device, graphicsFamily, 0, &graphicsQueue);
+
+    queueFamilyIndex = graphicsFamily;
 }
 
 void createSwapchain() {
@@ -264,6 +290,11 @@ void createSwapchain() {
     swapchainCreateInfo.imageExtent = { width, height };
     swapchainCreateInfo.imageArrayLayers = 1;
     swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    // Für die Aufnahme wird aus den Swapchain Images zurückgelesen
+    if (captureOptions.isEnabled()) {
+        swapchainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
     swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapchainCreateInfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
     swapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
@@ -312,6 +343,14 @@ void createImageViews() {
     }
 }
 
+void createOffscreenTargets() {
+
+    offscreenTargets.create(memoryTypes, device, swapChainImageFormat, { width, height }, MAX_FRAMES_IN_FLIGHT);
+
+    swapChainImages = offscreenTargets.getImages();
+    swapChainImageViews = offscreenTargets.getImageViews();
+}
+
 std::vector<char> readFile(const std::string& filename) {
 
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
@@ -361,10 +400,78 @@ void createPipelineLayout() {
     }
 }
 
-void createGraphicsPipeline() {
+void createPostPipelineLayout() {
+
+    VkDescriptorSetLayoutBinding samplerBinding {};
+    samplerBinding.binding = 0;
+    samplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerBinding.descriptorCount = 1;
+    samplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    samplerBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo {};
+    descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorSetLayoutInfo.bindingCount = 1;
+    descriptorSetLayoutInfo.pBindings = &samplerBinding;
 
-    auto vertShaderCode = readFile("shaders/triangle.vert.spv");
-    auto fragShaderCode = readFile("shaders/triangle.frag.spv");
+    if (vkCreateDescriptorSetLayout(device, &descriptorSetLayoutInfo, nullptr, &postDescriptorSetLayout) != VK_SUCCESS) {
+        std::cerr << "Descriptor Set Layout konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Die Richtung des Blurs, Composite ignoriert sie
+    VkPushConstantRange pushConstantRange {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(float) * 2;
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &postDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &postPipelineLayout) != VK_SUCCESS) {
+        std::cerr << "Pipeline Layout konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    VkSamplerCreateInfo samplerInfo {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &postSampler) != VK_SUCCESS) {
+        std::cerr << "Sampler konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    VkDescriptorPoolSize poolSize {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = 3;
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo {};
+    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.maxSets = 3;
+    descriptorPoolInfo.poolSizeCount = 1;
+    descriptorPoolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        std::cerr << "Descriptor Pool konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+VkPipeline createGraphicsPipeline(const std::string& vertShaderFile, const std::string& fragShaderFile, VkPipelineLayout layout, VkSampleCountFlagBits samples) {
+
+    auto vertShaderCode = readFile(vertShaderFile);
+    auto fragShaderCode = readFile(fragShaderFile);
 
     VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
     VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -425,7 +532,7 @@ void createGraphicsPipeline() {
     VkPipelineMultisampleStateCreateInfo multisampling {};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.rasterizationSamples = samples;
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -460,11 +567,12 @@ void createGraphicsPipeline() {
     graphicsPipelineCreateInfo.pRasterizationState = &rasterizer;
     graphicsPipelineCreateInfo.pMultisampleState = &multisampling;
     graphicsPipelineCreateInfo.pColorBlendState = &colorBlending;
-    graphicsPipelineCreateInfo.layout = pipelineLayout;
+    graphicsPipelineCreateInfo.layout = layout;
     graphicsPipelineCreateInfo.renderPass = VK_NULL_HANDLE;
     graphicsPipelineCreateInfo.subpass = 0;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+    VkPipeline pipeline;
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
         std::cout << "Graphics Pipeline konnte nicht erstellt werden!" << std::endl;
         exit(EXIT_FAILURE);
     }
@@ -472,6 +580,48 @@ void createGraphicsPipeline() {
     // Shader-Module können nach dem Linken der Pipeline wieder gelöscht werden
     vkDestroyShaderModule(device, fragShaderModule, nullptr);
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
+
+    return pipeline;
+}
+
+// Nach renderGraph.compile(), vorher gibt es die Image Views der transienten Images noch nicht
+VkDescriptorSet createPostDescriptorSet(RenderResource resource) {
+
+    // Verworfene Passes lassen ihre Images ungenutzt, dafür wird auch kein Set gebraucht
+    const VkImageView imageView = renderGraph.getImageView(resource);
+    if (imageView == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo {};
+    descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descriptorSetAllocateInfo.descriptorPool = descriptorPool;
+    descriptorSetAllocateInfo.descriptorSetCount = 1;
+    descriptorSetAllocateInfo.pSetLayouts = &postDescriptorSetLayout;
+
+    VkDescriptorSet descriptorSet;
+    if (vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &descriptorSet) != VK_SUCCESS) {
+        std::cerr << "Descriptor Set konnte nicht allokiert werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    VkDescriptorImageInfo descriptorImageInfo {};
+    descriptorImageInfo.sampler = postSampler;
+    descriptorImageInfo.imageView = imageView;
+    descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet writeDescriptorSet {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.dstSet = descriptorSet;
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.dstArrayElement = 0;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSet.pImageInfo = &descriptorImageInfo;
+
+    vkUpdateDescriptorSets(device, 1, &writeDescriptorSet, 0, nullptr);
+
+    return descriptorSet;
 }
 
 void createCommandPool() {
@@ -508,55 +658,103 @@ void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
     VkCommandBufferBeginInfo commandBufferBeginInfo {};
     commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
-    if (vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
         std::cout << "Commandbuffer konnte nicht beginnen!" << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    imageLayoutTransition(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_NONE, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, swapChainImages.at(imageIndex));
-
-    constexpr VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-
-    VkRenderingAttachmentInfo renderingAttachmentInfo {};
-    renderingAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-    renderingAttachmentInfo.pNext = nullptr;
-    renderingAttachmentInfo.imageView = swapChainImageViews[imageIndex];
-    renderingAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    renderingAttachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
-    renderingAttachmentInfo.resolveImageView = VK_NULL_HANDLE;
-    renderingAttachmentInfo.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    renderingAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    renderingAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    renderingAttachmentInfo.clearValue = clearColor;
-
-    VkRenderingInfoKHR renderingInfo {};
-    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
-    renderingInfo.pNext = nullptr;
-    renderingInfo.flags = 0;
-    renderingInfo.renderArea.extent.width = width;
-    renderingInfo.renderArea.extent.height = height;
-    renderingInfo.renderArea.offset.x = 0;
-    renderingInfo.renderArea.offset.y = 0;
-    renderingInfo.layerCount = 1;
-    renderingInfo.viewMask = 0;
-    renderingInfo.colorAttachmentCount = 1;
-    renderingInfo.pColorAttachments = &renderingAttachmentInfo;
-    renderingInfo.pDepthAttachment = nullptr;
-    renderingInfo.pStencilAttachment = nullptr;
-
-    vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-    vkCmdEndRenderingKHR(commandBuffer);
-
-    imageLayoutTransition(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, swapChainImages.at(imageIndex));
-
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    gpuProfiler.beginFrame(commandBuffer, currentFrame);
+    gpuProfiler.beginScope("Frame");
+
+    // Barrieren, Layout-Übergänge und Load/Store Ops kommen aus dem kompilierten Graphen
+    renderGraph.setImportedImage(backbuffer, swapChainImages[imageIndex], swapChainImageViews[imageIndex]);
+    renderGraph.execute(commandBuffer);
+
+    gpuProfiler.endScope();
+
+    frameReadback.record(commandBuffer, currentFrame, swapChainImages[imageIndex], headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    if (deviceDispatch.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         std::cerr << "Command Buffer konnte nicht aufgezeichnet werden!" << std::endl;
         exit(EXIT_FAILURE);
     }
 }
 
+void createRenderGraph() {
+
+    renderGraph.create(memoryTypes, device, synchronization2Supported);
+
+    backbuffer = renderGraph.importImage("Backbuffer", swapChainImageFormat, { width, height }, headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    sceneColor = renderGraph.createImage("Scene", { swapChainImageFormat, { width, height } });
+    blurHorizontal = renderGraph.createImage("Blur horizontal", { swapChainImageFormat, { width, height } });
+    blurVertical = renderGraph.createImage("Blur vertikal", { swapChainImageFormat, { width, height } });
+
+    const auto drawTriangle = [](VkCommandBuffer commandBuffer) {
+        deviceDispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+        deviceDispatch.vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    };
+
+    if (msaaSamples == VK_SAMPLE_COUNT_1_BIT) {
+        renderGraph.addPass("Triangle")
+            .colorAttachment(sceneColor, VkClearColorValue {{ 0.0f, 0.0f, 0.0f, 1.0f }})
+            .execute(drawTriangle);
+    } else {
+        // Gerendert wird in ein transientes Multisample-Image, aufgelöst direkt in die Szene
+        const RenderResource multisampled = renderGraph.createImage("Multisample", { swapChainImageFormat, { width, height }, msaaSamples });
+
+        renderGraph.addPass("Triangle")
+            .colorAttachment(multisampled, VkClearColorValue {{ 0.0f, 0.0f, 0.0f, 1.0f }})
+            .resolve(multisampled, sceneColor)
+            .execute(drawTriangle);
+    }
+
+    renderGraph.addPass("Blur horizontal")
+        .read(sceneColor, ResourceUsage::Sampled, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT)
+        .colorAttachment(blurHorizontal)
+        .execute([](VkCommandBuffer commandBuffer) {
+            const float direction[2] = { 1.0f, 0.0f };
+            deviceDispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, blurPipeline);
+            deviceDispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, postPipelineLayout, 0, 1, &sceneDescriptorSet, 0, nullptr);
+            deviceDispatch.vkCmdPushConstants(commandBuffer, postPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(direction), direction);
+            deviceDispatch.vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+        });
+
+    renderGraph.addPass("Blur vertikal")
+        .read(blurHorizontal, ResourceUsage::Sampled, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT)
+        .colorAttachment(blurVertical)
+        .execute([](VkCommandBuffer commandBuffer) {
+            const float direction[2] = { 0.0f, 1.0f };
+            deviceDispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, blurPipeline);
+            deviceDispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, postPipelineLayout, 0, 1, &blurHorizontalDescriptorSet, 0, nullptr);
+            deviceDispatch.vkCmdPushConstants(commandBuffer, postPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(direction), direction);
+            deviceDispatch.vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+        });
+
+    // Der ganze Backbuffer wird überschrieben, der alte Inhalt muss nicht geladen werden
+    const RenderResource compositeInput = blurEnabled ? blurVertical : sceneColor;
+
+    renderGraph.addPass("Composite")
+        .read(compositeInput, ResourceUsage::Sampled, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT)
+        .colorAttachment(backbuffer, VkClearColorValue {{ 0.0f, 0.0f, 0.0f, 1.0f }})
+        .execute([](VkCommandBuffer commandBuffer) {
+            VkDescriptorSet descriptorSet = blurEnabled ? blurVerticalDescriptorSet : sceneDescriptorSet;
+            deviceDispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, compositePipeline);
+            deviceDispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, postPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+            deviceDispatch.vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+        });
+
+    renderGraph.compile();
+
+    sceneDescriptorSet = createPostDescriptorSet(sceneColor);
+    blurHorizontalDescriptorSet = createPostDescriptorSet(blurHorizontal);
+    blurVerticalDescriptorSet = createPostDescriptorSet(blurVertical);
+
+    if (printRenderGraph) {
+        renderGraph.print();
+    }
+}
+
 void createSyncObjects() {
 
     imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -583,14 +781,19 @@ void createSyncObjects() {
 
 void drawFrame() {
 
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    deviceDispatch.vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
 
-    uint32_t imageIndex;
-    vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    frameReadback.collect(currentFrame);
 
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    // Headless gehört das Offscreen Image fest zum Frame
+    uint32_t imageIndex = currentFrame;
+    if (!headlessOptions.enabled) {
+        deviceDispatch.vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    }
 
-    vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+    deviceDispatch.vkResetFences(device, 1, &inFlightFences[currentFrame]);
+
+    deviceDispatch.vkResetCommandBuffer(commandBuffers[currentFrame], 0);
     recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
 
     VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
@@ -598,32 +801,35 @@ void drawFrame() {
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headlessOptions.enabled ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
     VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headlessOptions.enabled ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+    if (deviceDispatch.vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
         std::cerr << "Queue Submit fehlgeschlagen!" << std::endl;
         exit(EXIT_FAILURE);
     }
+    benchmarkCounters.submits++;
 
-    VkPresentInfoKHR presentInfo {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    if (!headlessOptions.enabled) {
+        VkPresentInfoKHR presentInfo {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = signalSemaphores;
 
-    VkSwapchainKHR swapChains[] = { swapchain };
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &imageIndex;
+        VkSwapchainKHR swapChains[] = { swapchain };
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
+        presentInfo.pImageIndices = &imageIndex;
 
-    vkQueuePresentKHR(graphicsQueue, &presentInfo);
+        deviceDispatch.vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    }
 
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
@@ -642,13 +848,30 @@ void cleanup() {
     vkDestroyPipeline(device, graphicsPipeline, nullptr);
     vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 
-    for (auto imageView : swapChainImageViews) {
-        vkDestroyImageView(device, imageView, nullptr);
+    vkDestroyPipeline(device, compositePipeline, nullptr);
+    vkDestroyPipeline(device, blurPipeline, nullptr);
+    vkDestroyPipelineLayout(device, postPipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, postDescriptorSetLayout, nullptr);
+    vkDestroySampler(device, postSampler, nullptr);
+
+    if (headlessOptions.enabled) {
+        offscreenTargets.destroy(device);
+    } else {
+        for (auto imageView : swapChainImageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(device, swapchain, nullptr);
     }
-    vkDestroySwapchainKHR(device, swapchain, nullptr);
+
+    renderGraph.destroy();
+    frameReadback.destroy();
+    gpuProfiler.destroy();
 
     vkDestroyDevice(device, nullptr);
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (!headlessOptions.enabled) {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
 
     destroyDebugUtilsMessengerEXT(instance, debugUtilsMessenger, nullptr);
     vkDestroyInstance(instance, nullptr);
@@ -656,62 +879,163 @@ void cleanup() {
 
 int main(int argc, char* argv[]) {
 
-    if (!SDL_Init(SDL_INIT_VIDEO)) {
-        std::cout << "SDL konnte nicht initialisiert werden: " << SDL_GetError() << std::endl;
-        return EXIT_FAILURE;
+    headlessOptions = parseHeadlessOptions(argc, argv);
+    goldenImageOptions = parseGoldenImageOptions(argc, argv);
+    captureOptions = parseCaptureOptions(argc, argv);
+
+    // Referenzbilder werden immer ohne Fenster gerendert
+    if (goldenImageOptions.isEnabled()) {
+        headlessOptions.enabled = true;
     }
 
+    bool dispatchBenchmark = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--dispatch-benchmark") {
+            dispatchBenchmark = true;
+        } else if (std::string(argv[i]) == "--msaa" && i + 1 < argc) {
+            requestedSamples = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::string(argv[i]) == "--no-blur") {
+            blurEnabled = false;
+        } else if (std::string(argv[i]) == "--print-graph") {
+            printRenderGraph = true;
+        }
+    }
 
-    SDL_PropertiesID properties = SDL_CreateProperties();
-    SDL_SetStringProperty(properties, SDL_PROP_WINDOW_CREATE_TITLE_STRING, "Hello Vulkan SDL3");
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, 800);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, 600);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_VULKAN);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_RESIZABLE);
+    if (!headlessOptions.enabled) {
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            std::cout << "SDL konnte nicht initialisiert werden: " << SDL_GetError() << std::endl;
+            return EXIT_FAILURE;
+        }
 
-    window = SDL_CreateWindowWithProperties(properties);
-    SDL_DestroyProperties(properties);
 
-    if (!window) {
-        std::cout << "Fenster konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
-        SDL_Quit();
-        return EXIT_FAILURE;
+        SDL_PropertiesID properties = SDL_CreateProperties();
+        SDL_SetStringProperty(properties, SDL_PROP_WINDOW_CREATE_TITLE_STRING, "Hello Vulkan SDL3");
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, 800);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, 600);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_VULKAN);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_RESIZABLE);
+
+        window = SDL_CreateWindowWithProperties(properties);
+        SDL_DestroyProperties(properties);
+
+        if (!window) {
+            std::cout << "Fenster konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
+            SDL_Quit();
+            return EXIT_FAILURE;
+        }
     }
 
     createInstance();
-    createSurface();
+    if (!headlessOptions.enabled) {
+        createSurface();
+    }
     pickPhysicalDevice();
     createDevice();
-    createSwapchain();
-    createImageViews();
+    deviceDispatch.load(device);
+    gpuProfiler.create(deviceCapabilities, device, queueFamilyIndex, MAX_FRAMES_IN_FLIGHT);
+    if (headlessOptions.enabled) {
+        createOffscreenTargets();
+    } else {
+        createSwapchain();
+        createImageViews();
+    }
     createPipelineLayout();
-    createGraphicsPipeline();
+    createPostPipelineLayout();
+    graphicsPipeline = createGraphicsPipeline("shaders/triangle.vert.spv", "shaders/triangle.frag.spv", pipelineLayout, msaaSamples);
+    blurPipeline = createGraphicsPipeline("shaders/fullscreen.vert.spv", "shaders/blur.frag.spv", postPipelineLayout, VK_SAMPLE_COUNT_1_BIT);
+    compositePipeline = createGraphicsPipeline("shaders/fullscreen.vert.spv", "shaders/composite.frag.spv", postPipelineLayout, VK_SAMPLE_COUNT_1_BIT);
     createCommandPool();
     createCommandBuffers();
     createSyncObjects();
+    createRenderGraph();
+
+    if (dispatchBenchmark) {
+        const DispatchOverhead overhead = measureDispatchOverhead(instance, device, commandPool, 1000000);
+        std::cout << "vkCmdSetViewport pro Aufruf: " << overhead.lookupNs << " ns mit vkGetInstanceProcAddr, " << overhead.loaderNs << " ns über den Loader, " << overhead.directNs << " ns über die Dispatch-Tabelle" << std::endl;
+    }
 
-    bool running = true;
-    SDL_Event event;
+    if (goldenImageOptions.isEnabled() || captureOptions.isEnabled()) {
+        frameReadback.create(memoryTypes, device, { width, height }, swapChainImageFormat, MAX_FRAMES_IN_FLIGHT, [](const ReadbackFrame& frame) {
+            if (goldenImageOptions.isEnabled()) {
+                goldenImageTest.capture(frame);
+            }
+            frameCapture.push(frame);
+        });
+    }
+
+    if (captureOptions.isEnabled()) {
+        frameCapture.start(captureOptions, width, height, swapChainImageFormat);
+    }
+
+    if (!headlessOptions.benchmarkPath.empty()) {
+        runBenchmark("dynamic_rendering", device, headlessOptions, gpuProfiler, memoryTypes, drawFrame);
+    } else if (headlessOptions.enabled) {
+        runHeadless(device, headlessOptions.frameCount, drawFrame);
+    } else {
+        SDL_ShowWindow(window);
 
-    SDL_ShowWindow(window);
+        // Der Hauptthread verarbeitet nur noch Events, gerendert wird auf dem Render Thread
+        renderThread.start(drawFrame);
 
-    while (running) {
-        while (SDL_PollEvent(&event)) {
+        bool running = true;
+        SDL_Event event;
+
+        while (running && SDL_WaitEvent(&event)) {
             if (event.type == SDL_EVENT_QUIT) {
                 running = false;
+            } else if (const std::optional<InputEvent> inputEvent = translateEvent(event)) {
+                renderThread.post(*inputEvent);
             }
+        }
 
-            drawFrame();
+        renderThread.stop();
+    }
+
+    // Die letzten Frames in Flight sind noch nicht ausgelesen
+    vkDeviceWaitIdle(device);
+    gpuProfiler.flush();
+
+    int exitCode = EXIT_SUCCESS;
+    if (frameReadback.isEnabled()) {
+        vkDeviceWaitIdle(device);
+        frameReadback.flush();
+        frameCapture.stop();
+
+        if (goldenImageOptions.isEnabled()) {
+            exitCode = goldenImageTest.finish(goldenImageOptions);
         }
     }
 
-    SDL_HideWindow(window);
+    std::cout << "MSAA: " << msaaSamples << "x (angefordert " << requestedSamples << "x)" << std::endl;
+    for (const GpuScopeStats& scope : gpuProfiler.getStats()) {
+        std::cout << "GPU " << scope.name << ": min " << scope.minMs << " ms, avg " << scope.avgMs << " ms, p99 " << scope.p99Ms << " ms (" << scope.samples << " Frames)" << std::endl;
+    }
+
+    const RenderGraphStats graphStats = renderGraph.getStats();
+    std::cout << "Render Graph: " << graphStats.passes - graphStats.culledPasses << " von " << graphStats.passes << " Passes aktiv, " << graphStats.barriersPerFrame << " Übergänge pro Frame" << std::endl;
+    if (graphStats.transientImages > 0) {
+        std::cout << "Transiente Images: " << graphStats.transientImages << " in " << graphStats.transientBytes << " Bytes, ohne Aliasing " << graphStats.transientBytesWithoutAliasing << " Bytes (" << graphStats.transientBytesWithoutAliasing - graphStats.transientBytes << " gespart, " << graphStats.aliasedImages << " Images teilen sich Speicher), davon " << graphStats.lazyImages << " lazy mit " << graphStats.lazyBytes << " Bytes" << std::endl;
+    }
+
+    const BarrierBatchStats barrierStats = renderGraph.getBarrierStats();
+    if (barrierStats.frames > 0) {
+        std::cout << "Barrieren (" << (renderGraph.usesSynchronization2() ? "synchronization2" : "klassisch") << "): " << static_cast<double>(barrierStats.barrierCalls) / barrierStats.frames << " Aufrufe mit " << static_cast<double>(barrierStats.imageBarriers) / barrierStats.frames << " Übergängen pro Frame" << std::endl;
+    }
+
+    const MemoryTypeStats memoryStats = memoryTypes.getStats();
+    std::cout << "Speicher: " << memoryStats.allocations << " Allokationen, " << memoryStats.fallbacks << " davon ausgewichen, Budget " << (memoryStats.budgetSupported ? "über VK_EXT_memory_budget" : "geschätzt") << std::endl;
+
+    if (!headlessOptions.enabled) {
+        SDL_HideWindow(window);
+    }
 
     vkDeviceWaitIdle(device);
     cleanup();
 
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    if (!headlessOptions.enabled) {
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+    }
 
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -6,6 +6,18 @@
 #include <array>
 #include <fstream>
 
+#include "../../common/Benchmark.h"
+#include "../../common/DeviceDispatch.h"
+#include "../../common/DeviceSelection.h"
+#include "../../common/FrameCapture.h"
+#include "../../common/GoldenImage.h"
+#include "../../common/GpuProfiler.h"
+#include "../../common/Headless.h"
+#include "../../common/MemoryTypes.h"
+#include "../../common/Readback.h"
+#include "../../common/RenderThread.h"
+#include "../../common/RenderingContext.h"
+
 const std::vector<const char*> validationLayers = {
     "VK_LAYER_KHRONOS_validation"
 };
@@ -30,13 +42,13 @@ VkInstance instance;
 VkDebugUtilsMessengerEXT debugUtilsMessenger;
 VkSurfaceKHR surface;
 VkPhysicalDevice physicalDevice;
+DeviceCapabilities deviceCapabilities;
+MemoryTypeSelector memoryTypes;
 VkDevice device;
 VkQueue graphicsQueue;
 VkSwapchainKHR swapchain;
 std::vector<VkImage> swapChainImages;
 std::vector<VkImageView> swapChainImageViews;
-VkRenderPass renderPass;
-std::vector<VkFramebuffer> framebuffers;
 VkPipelineLayout pipelineLayout;
 VkPipeline graphicsPipeline;
 VkCommandPool commandPool;
@@ -47,6 +59,26 @@ std::vector<VkFence> inFlightFences;
 
 uint32_t MAX_IMAGE_SIZE = 2;
 
+HeadlessOptions headlessOptions;
+OffscreenTargets offscreenTargets;
+FrameReadback frameReadback;
+
+GoldenImageOptions goldenImageOptions;
+GoldenImageTest goldenImageTest;
+
+CaptureOptions captureOptions;
+FrameCapture frameCapture;
+
+RenderingOptions renderingOptions;
+RenderingContext renderingContext;
+RenderingLayout renderingLayout;
+bool dynamicRenderingSupported = false;
+
+RenderThread renderThread;
+
+uint32_t queueFamilyIndex;
+GpuProfiler gpuProfiler;
+
 VkResult createDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) {
     auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
     if (func != nullptr) {
@@ -73,7 +105,8 @@ VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBits
 
 void createInstance() {
     uint32_t extensionCount = 0;
-    const char* const* extensions = SDL_Vulkan_GetInstanceExtensions(&extensionCount);
+    // Headless werden keine Surface-Erweiterungen benötigt, SDL ist dann nicht initialisiert
+    const char* const* extensions = headlessOptions.enabled ? nullptr : SDL_Vulkan_GetInstanceExtensions(&extensionCount);
 
     std::vector<const char*> extensionList {};
     extensionList.push_back("VK_EXT_debug_utils");
@@ -88,7 +121,7 @@ void createInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_3;
 
     VkDebugUtilsMessengerCreateInfoEXT debugUtilsMessengerCreateInfo;
     debugUtilsMessengerCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
@@ -136,47 +169,39 @@ void createSurface() {
 
 void pickPhysicalDevice() {
 
-    uint32_t deviceCount = 0;
-    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    DeviceRequirements requirements {};
+    requirements.surface = headlessOptions.enabled ? VK_NULL_HANDLE : surface;
 
-    if (deviceCount == 0) {
-        std::cout << "Keine Grafikkarte mit Vulkan-Unterstützung gefunden!" << std::endl;
-        exit(EXIT_FAILURE);
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        requirements.extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
 
-    std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    deviceCapabilities = selectPhysicalDevice(instance, requirements);
+    physicalDevice = deviceCapabilities.physicalDevice;
 
-    physicalDevice = devices[0];
-
-    VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
-    std::cout << "GPU gefunden: " << deviceProperties.deviceName << std::endl;
+    const VkPhysicalDeviceProperties& deviceProperties = deviceCapabilities.properties;
+    std::cout << "GPU gewählt: " << deviceProperties.deviceName << std::endl;
 }
 
 void createDevice() {
 
-    const std::vector<const char*> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
-
-    uint32_t queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    std::vector<const char*> deviceExtensions;
 
-    int graphicsFamily = -1;
-    for (int i = 0; i < queueFamilyCount; i++) {
-        if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            graphicsFamily = i;
-            break;
-        }
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
 
-    if (graphicsFamily == -1) {
-        std::cout << "Keine passende Queue Family gefunden!" << std::endl;
-        exit(EXIT_FAILURE);
-    }
+    // Ohne Unterstützung bleibt es bei Render Pass und Framebuffer
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures {};
+    dynamicRenderingSupported = RenderingContext::enableDynamicRendering(deviceCapabilities, renderingOptions, deviceExtensions, dynamicRenderingFeatures);
+
+    // Mit Budget weicht die Speicherwahl auf andere Heaps aus, bevor der Treiber auslagern muss
+    const bool memoryBudgetEnabled = MemoryTypeSelector::enableMemoryBudget(deviceCapabilities, deviceExtensions);
+
+    // Bei der Auswahl geprüft, mit Surface auch für Present
+    const uint32_t graphicsFamily = deviceCapabilities.graphicsFamily;
 
     float queuePriority = 1.0f;
     VkDeviceQueueCreateInfo queueCreateInfo {};
@@ -189,6 +214,7 @@ void createDevice() {
 
     VkDeviceCreateInfo deviceCreateInfo {};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceCreateInfo.pNext = dynamicRenderingSupported ? &dynamicRenderingFeatures : nullptr;
     deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
     deviceCreateInfo.queueCreateInfoCount = 1;
     deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
@@ -200,7 +226,11 @@ void createDevice() {
         exit(EXIT_FAILURE);
     }
 
+    memoryTypes.create(physicalDevice, deviceCapabilities.memoryProperties, memoryBudgetEnabled);
+
     vkGetDeviceQueue(device, graphicsFamily, 0, &graphicsQueue);
+
+    queueFamilyIndex = graphicsFamily;
 }
 
 void createSwapchain() {
@@ -214,6 +244,11 @@ void createSwapchain() {
     swapchainCreateInfo.imageExtent = { width, height };
     swapchainCreateInfo.imageArrayLayers = 1;
     swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    // Für die Aufnahme wird aus den Swapchain Images zurückgelesen
+    if (captureOptions.isEnabled()) {
+        swapchainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
     swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapchainCreateInfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
     swapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
@@ -262,87 +297,20 @@ void createImageViews() {
     }
 }
 
-void createRenderPass() {
-
-    std::array<VkAttachmentReference, 1> attachmentReferences = {};
-    attachmentReferences[0].attachment = 0;
-    attachmentReferences[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    std::array<VkAttachmentDescription, 1> attachmentDescription {};
-
-    attachmentDescription[0].flags = 0;
-    attachmentDescription[0].format = swapChainImageFormat;
-    attachmentDescription[0].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachmentDescription[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachmentDescription[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachmentDescription[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachmentDescription[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachmentDescription[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachmentDescription[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    std::array<VkSubpassDescription, 1> subpassDescription {};
-
-    subpassDescription[0].flags = 0;
-    subpassDescription[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpassDescription[0].inputAttachmentCount = 0;
-    subpassDescription[0].pInputAttachments = nullptr;
-    subpassDescription[0].colorAttachmentCount = static_cast<uint32_t>(attachmentReferences.size());
-    subpassDescription[0].pColorAttachments = attachmentReferences.data();
-    subpassDescription[0].pResolveAttachments = nullptr;
-    subpassDescription[0].pDepthStencilAttachment = nullptr;
-    subpassDescription[0].preserveAttachmentCount = 0;
-    subpassDescription[0].pPreserveAttachments = nullptr;
-
-    std::array<VkSubpassDependency, 1> subpassDependencies {};
-    subpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-    subpassDependencies[0].dstSubpass = 0;
-    subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpassDependencies[0].srcAccessMask = 0;
-    subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    VkRenderPassCreateInfo renderPassCreateInfo = {};
-    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassCreateInfo.pNext = nullptr;
-    renderPassCreateInfo.flags = 0;
-    renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachmentDescription.size());
-    renderPassCreateInfo.pAttachments = attachmentDescription.data();
-    renderPassCreateInfo.subpassCount = static_cast<u_int32_t>(subpassDescription.size());
-    renderPassCreateInfo.pSubpasses = subpassDescription.data();
-    renderPassCreateInfo.dependencyCount = static_cast<uint32_t>(subpassDependencies.size());
-    renderPassCreateInfo.pDependencies = subpassDependencies.data();
-
-    const VkResult result = vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass);
-    if (result != VK_SUCCESS) {
-        std::cout << "RenderPass konnte nicht erstellt werden!" << std::endl;
-        exit(EXIT_FAILURE);
-    }
-}
-
-void createFramebuffers() {
+void createOffscreenTargets() {
 
-    framebuffers.resize(swapChainImageViews.size());
+    offscreenTargets.create(memoryTypes, device, swapChainImageFormat, { width, height }, MAX_FRAMES_IN_FLIGHT);
 
-    for (size_t i = 0; i < swapChainImageViews.size(); i++) {
+    swapChainImages = offscreenTargets.getImages();
+    swapChainImageViews = offscreenTargets.getImageViews();
+}
 
-        VkImageView attachments[] = {
-            swapChainImageViews[i]
-        };
+void createRenderingContext() {
 
-        VkFramebufferCreateInfo framebufferInfo {};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = width;
-        framebufferInfo.height = height;
-        framebufferInfo.layers = 1;
+    renderingContext.create(device, dynamicRenderingSupported, MAX_FRAMES_IN_FLIGHT, renderingOptions);
 
-        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS) {
-            std::cerr << "Framebuffer konnte nicht erstellt werden!" << std::endl;
-            exit(EXIT_FAILURE);
-        }
-    }
+    renderingLayout.colorFormat = swapChainImageFormat;
+    renderingLayout.finalLayout = headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 }
 
 std::vector<char> readFile(const std::string& filename) {
@@ -482,8 +450,9 @@ void createGraphicsPipeline() {
     graphicsPipelineCreateInfo.pMultisampleState = &multisampling;
     graphicsPipelineCreateInfo.pColorBlendState = &colorBlending;
     graphicsPipelineCreateInfo.layout = pipelineLayout;
-    graphicsPipelineCreateInfo.renderPass = renderPass;
-    graphicsPipelineCreateInfo.subpass = 0;
+
+    VkPipelineRenderingCreateInfoKHR pipelineRenderingCreateInfo {};
+    renderingContext.preparePipeline(renderingLayout, graphicsPipelineCreateInfo, pipelineRenderingCreateInfo);
 
     if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
         std::cout << "Graphics Pipeline konnte nicht erstellt werden!" << std::endl;
@@ -510,7 +479,7 @@ void createCommandPool() {
 
 void createCommandBuffers() {
 
-    commandBuffers.resize(framebuffers.size());
+    commandBuffers.resize(swapChainImageViews.size());
 
     VkCommandBufferAllocateInfo commandBufferAllocateInfo {};
     commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -529,28 +498,30 @@ void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
     VkCommandBufferBeginInfo commandBufferBeginInfo {};
     commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
-    if (vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
         std::cout << "Commandbuffer konnte nicht beginnen!" << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    VkRenderPassBeginInfo renderPassBeginInfo {};
-    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassBeginInfo.renderPass = renderPass;
-    renderPassBeginInfo.framebuffer = framebuffers[imageIndex];
-    renderPassBeginInfo.renderArea.offset = {0, 0};
-    renderPassBeginInfo.renderArea.extent = {width, height};
+    gpuProfiler.beginFrame(commandBuffer, currentFrame);
+    gpuProfiler.beginScope("Frame");
 
-    constexpr VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassBeginInfo.clearValueCount = 1;
-    renderPassBeginInfo.pClearValues = &clearColor;
+    RenderingTargets renderingTargets {};
+    renderingTargets.extent = {width, height};
+    renderingTargets.image = swapChainImages[imageIndex];
+    renderingTargets.imageView = swapChainImageViews[imageIndex];
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-    vkCmdEndRenderPass(commandBuffer);
+    renderingContext.begin(commandBuffer, renderingLayout, renderingTargets);
+    deviceDispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    deviceDispatch.vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    renderingContext.end(commandBuffer);
+    renderingContext.endFrame();
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    gpuProfiler.endScope();
+
+    frameReadback.record(commandBuffer, currentFrame, swapChainImages[imageIndex], headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    if (deviceDispatch.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         std::cerr << "Command Buffer konnte nicht aufgezeichnet werden!" << std::endl;
         exit(EXIT_FAILURE);
     }
@@ -582,14 +553,19 @@ void createSyncObjects() {
 
 void drawFrame() {
 
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    deviceDispatch.vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
 
-    uint32_t imageIndex;
-    vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    frameReadback.collect(currentFrame);
+
+    // Headless gehört das Offscreen Image fest zum Frame
+    uint32_t imageIndex = currentFrame;
+    if (!headlessOptions.enabled) {
+        deviceDispatch.vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    }
 
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    deviceDispatch.vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
-    vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+    deviceDispatch.vkResetCommandBuffer(commandBuffers[currentFrame], 0);
     recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
 
     VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
@@ -597,32 +573,35 @@ void drawFrame() {
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headlessOptions.enabled ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
     VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headlessOptions.enabled ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+    if (deviceDispatch.vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
         std::cerr << "Queue Submit fehlgeschlagen!" << std::endl;
         exit(EXIT_FAILURE);
     }
+    benchmarkCounters.submits++;
 
-    VkPresentInfoKHR presentInfo {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    if (!headlessOptions.enabled) {
+        VkPresentInfoKHR presentInfo {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = signalSemaphores;
 
-    VkSwapchainKHR swapChains[] = { swapchain };
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &imageIndex;
+        VkSwapchainKHR swapChains[] = { swapchain };
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
+        presentInfo.pImageIndices = &imageIndex;
 
-    vkQueuePresentKHR(graphicsQueue, &presentInfo);
+        deviceDispatch.vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    }
 
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
@@ -641,19 +620,24 @@ void cleanup() {
     vkDestroyPipeline(device, graphicsPipeline, nullptr);
     vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 
-    for (auto framebuffer : framebuffers) {
-        vkDestroyFramebuffer(device, framebuffer, nullptr);
-    }
-
-    vkDestroyRenderPass(device, renderPass, nullptr);
+    renderingContext.destroy();
 
-    for (auto imageView : swapChainImageViews) {
-        vkDestroyImageView(device, imageView, nullptr);
+    if (headlessOptions.enabled) {
+        offscreenTargets.destroy(device);
+    } else {
+        for (auto imageView : swapChainImageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(device, swapchain, nullptr);
     }
-    vkDestroySwapchainKHR(device, swapchain, nullptr);
+
+    frameReadback.destroy();
+    gpuProfiler.destroy();
 
     vkDestroyDevice(device, nullptr);
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (!headlessOptions.enabled) {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
 
     destroyDebugUtilsMessengerEXT(instance, debugUtilsMessenger, nullptr);
 
@@ -662,64 +646,126 @@ void cleanup() {
 
 int main(int argc, char* argv[]) {
 
-    if (!SDL_Init(SDL_INIT_VIDEO)) {
-        std::cout << "SDL konnte nicht initialisiert werden: " << SDL_GetError() << std::endl;
-        return EXIT_FAILURE;
+    headlessOptions = parseHeadlessOptions(argc, argv);
+    goldenImageOptions = parseGoldenImageOptions(argc, argv);
+    captureOptions = parseCaptureOptions(argc, argv);
+    renderingOptions = parseRenderingOptions(argc, argv);
+
+    // Referenzbilder werden immer ohne Fenster gerendert
+    if (goldenImageOptions.isEnabled()) {
+        headlessOptions.enabled = true;
     }
 
+    if (!headlessOptions.enabled) {
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            std::cout << "SDL konnte nicht initialisiert werden: " << SDL_GetError() << std::endl;
+            return EXIT_FAILURE;
+        }
 
-    SDL_PropertiesID properties = SDL_CreateProperties();
-    SDL_SetStringProperty(properties, SDL_PROP_WINDOW_CREATE_TITLE_STRING, "Hello Vulkan SDL3");
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, 800);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, 600);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_VULKAN);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_RESIZABLE);
 
-    window = SDL_CreateWindowWithProperties(properties);
-    SDL_DestroyProperties(properties);
+        SDL_PropertiesID properties = SDL_CreateProperties();
+        SDL_SetStringProperty(properties, SDL_PROP_WINDOW_CREATE_TITLE_STRING, "Hello Vulkan SDL3");
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, 800);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, 600);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_VULKAN);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_RESIZABLE);
 
-    if (!window) {
-        std::cout << "Fenster konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
-        SDL_Quit();
-        return EXIT_FAILURE;
+        window = SDL_CreateWindowWithProperties(properties);
+        SDL_DestroyProperties(properties);
+
+        if (!window) {
+            std::cout << "Fenster konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
+            SDL_Quit();
+            return EXIT_FAILURE;
+        }
     }
 
     createInstance();
-    createSurface();
+    if (!headlessOptions.enabled) {
+        createSurface();
+    }
     pickPhysicalDevice();
     createDevice();
-    createSwapchain();
-    createImageViews();
-    createRenderPass();
-    createFramebuffers();
+    deviceDispatch.load(device);
+    gpuProfiler.create(deviceCapabilities, device, queueFamilyIndex, MAX_FRAMES_IN_FLIGHT);
+    if (headlessOptions.enabled) {
+        createOffscreenTargets();
+    } else {
+        createSwapchain();
+        createImageViews();
+    }
+    createRenderingContext();
     createPipelineLayout();
     createGraphicsPipeline();
     createCommandPool();
     createCommandBuffers();
     createSyncObjects();
 
-    bool running = true;
-    SDL_Event event;
+    if (goldenImageOptions.isEnabled() || captureOptions.isEnabled()) {
+        frameReadback.create(memoryTypes, device, { width, height }, swapChainImageFormat, MAX_FRAMES_IN_FLIGHT, [](const ReadbackFrame& frame) {
+            if (goldenImageOptions.isEnabled()) {
+                goldenImageTest.capture(frame);
+            }
+            frameCapture.push(frame);
+        });
+    }
+
+    if (captureOptions.isEnabled()) {
+        frameCapture.start(captureOptions, width, height, swapChainImageFormat);
+    }
+
+    if (!headlessOptions.benchmarkPath.empty()) {
+        runBenchmark("hello_world", device, headlessOptions, gpuProfiler, memoryTypes, drawFrame);
+    } else if (headlessOptions.enabled) {
+        runHeadless(device, headlessOptions.frameCount, drawFrame);
+    } else {
+        SDL_ShowWindow(window);
+
+        // Der Hauptthread verarbeitet nur noch Events, gerendert wird auf dem Render Thread
+        renderThread.start(drawFrame);
 
-    SDL_ShowWindow(window);
+        bool running = true;
+        SDL_Event event;
 
-    while (running) {
-        while (SDL_PollEvent(&event)) {
+        while (running && SDL_WaitEvent(&event)) {
             if (event.type == SDL_EVENT_QUIT) {
                 running = false;
+            } else if (const std::optional<InputEvent> inputEvent = translateEvent(event)) {
+                renderThread.post(*inputEvent);
             }
+        }
 
-            drawFrame();
+        renderThread.stop();
+    }
+
+    int exitCode = EXIT_SUCCESS;
+    if (frameReadback.isEnabled()) {
+        vkDeviceWaitIdle(device);
+        frameReadback.flush();
+        frameCapture.stop();
+
+        if (goldenImageOptions.isEnabled()) {
+            exitCode = goldenImageTest.finish(goldenImageOptions);
         }
     }
 
-    SDL_HideWindow(window);
+    const RenderPassCacheStats cacheStats = renderingContext.getCacheStats();
+    std::cout << "Rendering: " << (renderingContext.usesDynamicRendering() ? "Dynamic Rendering" : "Render Pass") << ", " << cacheStats.renderPassesCreated << " Render Passes und " << cacheStats.framebuffersCreated << " Framebuffer erstellt, " << cacheStats.renderPassesEvicted + cacheStats.framebuffersEvicted << " verworfen, " << cacheStats.hits << " Treffer im Cache" << std::endl;
+
+    const MemoryTypeStats memoryStats = memoryTypes.getStats();
+    std::cout << "Speicher: " << memoryStats.allocations << " Allokationen, " << memoryStats.fallbacks << " davon ausgewichen, Budget " << (memoryStats.budgetSupported ? "über VK_EXT_memory_budget" : "geschätzt") << std::endl;
+
+    if (!headlessOptions.enabled) {
+        SDL_HideWindow(window);
+    }
 
     vkDeviceWaitIdle(device);
     cleanup();
 
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    if (!headlessOptions.enabled) {
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+    }
 
-    return 0;
+    return exitCode;
 }
@@ -8,7 +8,25 @@
 #include <queue>
 #include <span>
 
+#include "../../common/Benchmark.h"
+#include "../../common/CommandRecorder.h"
+#include "../../common/CpuTrace.h"
+#include "../../common/DeviceDispatch.h"
+#include "../../common/DeviceSelection.h"
+#include "../../common/FrameCapture.h"
+#include "../../common/FramePacer.h"
+#include "../../common/Frustum.h"
+#include "../../common/GoldenImage.h"
+#include "../../common/GpuProfiler.h"
+#include "../../common/Headless.h"
 #include "../../common/Matrix.h"
+#include "../../common/MemoryTypes.h"
+#include "../../common/PipelineStatistics.h"
+#include "../../common/Readback.h"
+#include "../../common/RenderQueue.h"
+#include "../../common/RenderThread.h"
+#include "../../common/RenderingContext.h"
+#include "../../common/SceneGraph.h"
 
 const std::vector<const char*> validationLayers = {
     "VK_LAYER_KHRONOS_validation"
@@ -34,16 +52,17 @@ VkInstance instance;
 VkDebugUtilsMessengerEXT debugUtilsMessenger;
 VkSurfaceKHR surface;
 VkPhysicalDevice physicalDevice;
+DeviceCapabilities deviceCapabilities;
+MemoryTypeSelector memoryTypes;
 VkDevice device;
 uint32_t queueFamilyIndex;
 VkQueue graphicsQueue;
 VkSwapchainKHR swapchain;
 std::vector<VkImage> swapChainImages;
 std::vector<VkImageView> swapChainImageViews;
-VkRenderPass renderPass;
-std::vector<VkFramebuffer> framebuffers;
 VkPipelineLayout pipelineLayout;
-VkPipeline graphicsPipeline;
+std::array<VkPipeline, 2> graphicsPipelines;
+VkPipeline depthPrepassPipeline = VK_NULL_HANDLE;
 std::vector<VkCommandPool> commandPools;
 std::vector<VkCommandBuffer> commandBuffers;
 std::vector<VkSemaphore> imageAvailableSemaphores;
@@ -52,6 +71,43 @@ std::vector<VkFence> inFlightFences;
 
 uint32_t MAX_IMAGE_SIZE = 2;
 
+VkFormat depthFormat;
+VkImage depthImage;
+VkDeviceMemory depthImageMemory;
+VkImageView depthImageView;
+
+// Über --msaa angefordert, wird in pickPhysicalDevice auf das vom Gerät Unterstützte begrenzt
+uint32_t requestedSamples = 1;
+VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+
+VkImage colorImage = VK_NULL_HANDLE;
+VkDeviceMemory colorImageMemory = VK_NULL_HANDLE;
+VkImageView colorImageView = VK_NULL_HANDLE;
+
+// Mit Pre-Pass schreiben zuerst alle Draws nur die Tiefe, der Farbdurchgang schattiert danach jedes Pixel genau einmal
+bool depthPrepass = false;
+bool frontToBack = true;
+
+HeadlessOptions headlessOptions;
+OffscreenTargets offscreenTargets;
+FrameReadback frameReadback;
+
+GoldenImageOptions goldenImageOptions;
+GoldenImageTest goldenImageTest;
+
+CaptureOptions captureOptions;
+FrameCapture frameCapture;
+
+RenderingOptions renderingOptions;
+RenderingContext renderingContext;
+RenderingLayout renderingLayout;
+bool dynamicRenderingSupported = false;
+
+RenderThread renderThread;
+
+FramePacerOptions framePacerOptions;
+FramePacer framePacer;
+
 struct Frame {
     VkCommandPool             commandPool;
     VkCommandBuffer           commandBuffer;
@@ -115,16 +171,31 @@ struct Buffer {
     void destroy(VkDevice device) const;
 };
 
-using VertexBuffer = Buffer;
+struct VertexBuffer : Buffer {
+    Bounds bounds;
+};
+
 using IndexBuffer = Buffer;
 
 void Buffer::destroy(VkDevice device) const {
-    vkFreeMemory(device, memory, nullptr);
+    memoryTypes.free(device, memory);
     vkDestroyBuffer(device, buffer, nullptr);
 }
 
-VertexBuffer vertexBuffer = {};
-IndexBuffer indexBuffer = {};
+struct Mesh {
+    VertexBuffer vertexBuffer;
+    IndexBuffer indexBuffer;
+    uint32_t indexCount;
+
+    void destroy(VkDevice device) const;
+};
+
+void Mesh::destroy(VkDevice device) const {
+    vertexBuffer.destroy(device);
+    indexBuffer.destroy(device);
+}
+
+std::array<Mesh, 2> meshes = {};
 
 constexpr  std::array<Vertex, 4> vertices = {
     Vertex {{-0.5, -0.5}, {1, 0, 0}},
@@ -138,12 +209,68 @@ constexpr std::array<uint32_t, 6> indices = {
     0, 1, 2, 2, 3, 0
 };
 
+constexpr std::array<Vertex, 3> triangleVertices = {
+    Vertex {{0.0, -0.5}, {1, 1, 0}},
+    Vertex {{0.5, 0.5}, {1, 0, 1}},
+    Vertex {{-0.5, 0.5}, {0, 1, 1}}
+};
+
+constexpr std::array<uint32_t, 3> triangleIndices = {
+    0, 1, 2
+};
+
 struct MeshPushConstant {
     Matrix4f transform;
 };
 
 MeshPushConstant meshPushConstant = {};
 
+constexpr uint32_t GROUP_GRID_SIZE = 4;
+constexpr uint32_t LEAF_GRID_SIZE = 8;
+
+// Ein Knoten im Szenengraph mit dem Mesh und der Pipeline, mit denen er gezeichnet wird
+struct Drawable {
+    uint32_t node;
+    uint32_t mesh;
+    uint32_t pipeline;
+};
+
+SceneGraph sceneGraph;
+std::vector<uint32_t> spinningGroups;
+std::vector<Drawable> drawables;
+
+uint64_t sceneGraphFrames = 0;
+uint64_t sceneGraphNodesUpdated = 0;
+
+Matrix4f viewProjection;
+float cameraTime = 0.0f;
+
+SphereList drawSpheres;
+std::vector<uint32_t> visibleDraws;
+CullingStats cullingStats;
+uint64_t culledDraws = 0;
+uint64_t testedDraws = 0;
+
+RenderQueue renderQueue;
+CommandRecorder commandRecorder;
+uint64_t bindsIssued = 0;
+uint64_t bindsSkipped = 0;
+uint64_t pushConstantsSkipped = 0;
+
+GpuProfiler gpuProfiler;
+bool calibratedTimestampsSupported = false;
+
+std::string tracePath;
+
+bool pipelineStatisticsSupported = false;
+PipelineStatistics pipelineStatistics;
+
+// Namen der Draw-Gruppen für die Pipeline Statistics, Index wie in graphicsPipelines
+const std::array<const char*, 2> pipelineNames = {
+    "Farbig",
+    "Graustufen"
+};
+
 VkResult createDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) {
     auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
     if (func != nullptr) {
@@ -169,8 +296,12 @@ VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBits
 }
 
 void createInstance() {
+
+    CpuTraceScope traceScope("createInstance");
+
     uint32_t extensionCount = 0;
-    const char* const* extensions = SDL_Vulkan_GetInstanceExtensions(&extensionCount);
+    // Headless werden keine Surface-Erweiterungen benötigt, SDL ist dann nicht initialisiert
+    const char* const* extensions = headlessOptions.enabled ? nullptr : SDL_Vulkan_GetInstanceExtensions(&extensionCount);
 
     std::vector<const char*> extensionList {};
     extensionList.push_back("VK_EXT_debug_utils");
@@ -185,7 +316,7 @@ void createInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_3;
 
     VkDebugUtilsMessengerCreateInfoEXT debugUtilsMessengerCreateInfo;
     debugUtilsMessengerCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
@@ -225,6 +356,8 @@ void createInstance() {
 
 void createSurface() {
 
+    CpuTraceScope traceScope("createSurface");
+
     if (!SDL_Vulkan_CreateSurface(window, instance, nullptr, &surface)) {
         std::cout << "Surface konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
         exit(EXIT_FAILURE);
@@ -233,52 +366,59 @@ void createSurface() {
 
 void pickPhysicalDevice() {
 
-    uint32_t deviceCount = 0;
-    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    CpuTraceScope traceScope("pickPhysicalDevice");
 
-    if (deviceCount == 0) {
-        std::cout << "Keine Grafikkarte mit Vulkan-Unterstützung gefunden!" << std::endl;
-        exit(EXIT_FAILURE);
+    DeviceRequirements requirements {};
+    requirements.surface = headlessOptions.enabled ? VK_NULL_HANDLE : surface;
+
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        requirements.extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
+    requirements.minPushConstantsSize = sizeof(MeshPushConstant);
 
-    std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    deviceCapabilities = selectPhysicalDevice(instance, requirements);
+    physicalDevice = deviceCapabilities.physicalDevice;
 
-    physicalDevice = devices[0];
+    const VkPhysicalDeviceProperties& deviceProperties = deviceCapabilities.properties;
+    std::cout << "GPU gewählt: " << deviceProperties.deviceName << std::endl;
 
-    VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
-    std::cout << "GPU gefunden: " << deviceProperties.deviceName << std::endl;
+    // Höchste Anzahl Samples bis zur angeforderten, die Color und Depth beide unterstützen
+    const VkSampleCountFlags supportedSamples = deviceProperties.limits.framebufferColorSampleCounts & deviceProperties.limits.framebufferDepthSampleCounts;
+    for (uint32_t count = 2; count <= requestedSamples && count <= VK_SAMPLE_COUNT_64_BIT; count *= 2) {
+        if (supportedSamples & count) {
+            msaaSamples = static_cast<VkSampleCountFlagBits>(count);
+        }
+    }
 }
 
 void createDevice() {
 
-    const std::vector<const char*> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+    CpuTraceScope traceScope("createDevice");
 
-    uint32_t queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
-
-    int graphicsFamily = -1;
-    for (int i = 0; i < queueFamilyCount; i++) {
-        if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            VkBool32 surfaceSupported = VK_FALSE;
-            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &surfaceSupported);
-            if (surfaceSupported) {
-                graphicsFamily = i;
-                break;
-            }
-        }
+    std::vector<const char*> deviceExtensions;
+
+    // Ohne Fenster wird keine Swapchain benötigt
+    if (!headlessOptions.enabled) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
 
-    if (graphicsFamily == -1) {
-        std::cout << "Keine passende Queue Family gefunden!" << std::endl;
-        exit(EXIT_FAILURE);
+    // Ohne Unterstützung bleibt es bei Render Pass und Framebuffer
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures {};
+    dynamicRenderingSupported = RenderingContext::enableDynamicRendering(deviceCapabilities, renderingOptions, deviceExtensions, dynamicRenderingFeatures);
+
+    // Mit Budget weicht die Speicherwahl auf andere Heaps aus, bevor der Treiber auslagern muss
+    const bool memoryBudgetEnabled = MemoryTypeSelector::enableMemoryBudget(deviceCapabilities, deviceExtensions);
+
+    // Erlaubt es, GPU-Zeitstempel auf die CPU-Zeitachse des Traces umzurechnen
+    if (deviceCapabilities.hasExtension(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+        deviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        calibratedTimestampsSupported = true;
     }
 
+    // Bei der Auswahl geprüft, mit Surface auch für Present
+    const uint32_t graphicsFamily = deviceCapabilities.graphicsFamily;
+
     float queuePriority = 1.0f;
     VkDeviceQueueCreateInfo queueCreateInfo {};
     queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -286,10 +426,15 @@ void createDevice() {
     queueCreateInfo.queueCount = 1;
     queueCreateInfo.pQueuePriorities = &queuePriority;
 
+    const VkPhysicalDeviceFeatures& supportedFeatures = deviceCapabilities.features;
+    pipelineStatisticsSupported = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
     VkPhysicalDeviceFeatures deviceFeatures {};
+    deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
 
     VkDeviceCreateInfo deviceCreateInfo {};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceCreateInfo.pNext = dynamicRenderingSupported ? &dynamicRenderingFeatures : nullptr;
     deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
     deviceCreateInfo.queueCreateInfoCount = 1;
     deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
@@ -301,12 +446,16 @@ void createDevice() {
         exit(EXIT_FAILURE);
     }
 
+    memoryTypes.create(physicalDevice, deviceCapabilities.memoryProperties, memoryBudgetEnabled);
+
     vkGetDeviceQueue(device, graphicsFamily, 0, &graphicsQueue);
     queueFamilyIndex = graphicsFamily;
 }
 
 void createSwapchain() {
 
+    CpuTraceScope traceScope("createSwapchain");
+
     VkSwapchainCreateInfoKHR swapchainCreateInfo {};
     swapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
     swapchainCreateInfo.surface = surface;
@@ -316,6 +465,11 @@ void createSwapchain() {
     swapchainCreateInfo.imageExtent = { width, height };
     swapchainCreateInfo.imageArrayLayers = 1;
     swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    // Für die Aufnahme wird aus den Swapchain Images zurückgelesen
+    if (captureOptions.isEnabled()) {
+        swapchainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
     swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapchainCreateInfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
     swapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
@@ -330,6 +484,8 @@ void createSwapchain() {
 
 void createImageViews() {
 
+    CpuTraceScope traceScope("createImageViews");
+
     uint32_t imageCount;
     vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
     swapChainImages.resize(imageCount);
@@ -364,87 +520,32 @@ void createImageViews() {
     }
 }
 
-void createRenderPass() {
-
-    std::array<VkAttachmentReference, 1> attachmentReferences = {};
-    attachmentReferences[0].attachment = 0;
-    attachmentReferences[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    std::array<VkAttachmentDescription, 1> attachmentDescription {};
-
-    attachmentDescription[0].flags = 0;
-    attachmentDescription[0].format = swapChainImageFormat;
-    attachmentDescription[0].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachmentDescription[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachmentDescription[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachmentDescription[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachmentDescription[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachmentDescription[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachmentDescription[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    std::array<VkSubpassDescription, 1> subpassDescription {};
-
-    subpassDescription[0].flags = 0;
-    subpassDescription[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpassDescription[0].inputAttachmentCount = 0;
-    subpassDescription[0].pInputAttachments = nullptr;
-    subpassDescription[0].colorAttachmentCount = static_cast<uint32_t>(attachmentReferences.size());
-    subpassDescription[0].pColorAttachments = attachmentReferences.data();
-    subpassDescription[0].pResolveAttachments = nullptr;
-    subpassDescription[0].pDepthStencilAttachment = nullptr;
-    subpassDescription[0].preserveAttachmentCount = 0;
-    subpassDescription[0].pPreserveAttachments = nullptr;
-
-    std::array<VkSubpassDependency, 1> subpassDependencies {};
-    subpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-    subpassDependencies[0].dstSubpass = 0;
-    subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpassDependencies[0].srcAccessMask = 0;
-    subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    VkRenderPassCreateInfo renderPassCreateInfo = {};
-    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassCreateInfo.pNext = nullptr;
-    renderPassCreateInfo.flags = 0;
-    renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachmentDescription.size());
-    renderPassCreateInfo.pAttachments = attachmentDescription.data();
-    renderPassCreateInfo.subpassCount = static_cast<uint32_t>(subpassDescription.size());
-    renderPassCreateInfo.pSubpasses = subpassDescription.data();
-    renderPassCreateInfo.dependencyCount = static_cast<uint32_t>(subpassDependencies.size());
-    renderPassCreateInfo.pDependencies = subpassDependencies.data();
-
-    const VkResult result = vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass);
-    if (result != VK_SUCCESS) {
-        std::cout << "RenderPass konnte nicht erstellt werden!" << std::endl;
-        exit(EXIT_FAILURE);
-    }
-}
+void createOffscreenTargets() {
+
+    CpuTraceScope traceScope("createOffscreenTargets");
 
-void createFramebuffers() {
+    offscreenTargets.create(memoryTypes, device, swapChainImageFormat, { width, height }, MAX_FRAMES_IN_FLIGHT);
 
-    framebuffers.resize(swapChainImageViews.size());
+    swapChainImages = offscreenTargets.getImages();
+    swapChainImageViews = offscreenTargets.getImageViews();
+}
 
-    for (size_t i = 0; i < swapChainImageViews.size(); i++) {
+void createRenderingContext() {
 
-        VkImageView attachments[] = {
-            swapChainImageViews[i]
-        };
+    CpuTraceScope traceScope("createRenderingContext");
 
-        VkFramebufferCreateInfo framebufferInfo {};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = width;
-        framebufferInfo.height = height;
-        framebufferInfo.layers = 1;
+    renderingContext.create(device, dynamicRenderingSupported, MAX_FRAMES_IN_FLIGHT, renderingOptions);
 
-        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS) {
-            std::cerr << "Framebuffer konnte nicht erstellt werden!" << std::endl;
-            exit(EXIT_FAILURE);
-        }
+    // Mit MSAA wird in colorImage gerendert und am Ende des Passes in das Swapchain Image aufgelöst
+    renderingLayout.colorFormat = swapChainImageFormat;
+    renderingLayout.depthFormat = depthFormat;
+    renderingLayout.samples = msaaSamples;
+
+    // Die Samples werden auf dem Tile aufgelöst und nie gespeichert
+    if (msaaSamples != VK_SAMPLE_COUNT_1_BIT) {
+        renderingLayout.colorStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     }
+    renderingLayout.finalLayout = headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 }
 
 std::vector<char> readFile(const std::string& filename) {
@@ -483,6 +584,8 @@ VkShaderModule createShaderModule(const std::vector<char>& code) {
 
 void createPipelineLayout() {
 
+    CpuTraceScope traceScope("createPipelineLayout");
+
     std::array<VkPushConstantRange, 1> pushConstantRanges = {};
 
     pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
@@ -502,13 +605,17 @@ void createPipelineLayout() {
     }
 }
 
-void createGraphicsPipeline() {
+// Ohne Fragment Shader entsteht die Pipeline für den Depth Pre-Pass
+VkPipeline createGraphicsPipeline(const std::string& fragShaderFile) {
+
+    CpuTraceScope traceScope("createGraphicsPipeline");
+
+    const bool depthOnly = fragShaderFile.empty();
 
     auto vertShaderCode = readFile("shaders/triangle.vert.spv");
-    auto fragShaderCode = readFile("shaders/triangle.frag.spv");
 
     VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+    VkShaderModule fragShaderModule = depthOnly ? VK_NULL_HANDLE : createShaderModule(readFile(fragShaderFile));
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -573,10 +680,11 @@ void createGraphicsPipeline() {
     VkPipelineMultisampleStateCreateInfo multisampling {};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.rasterizationSamples = msaaSamples;
 
+    // Der Pre-Pass läuft im selben Pass wie die Farbe, das Color Attachment bleibt gebunden und wird nur nicht beschrieben
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.colorWriteMask = depthOnly ? 0 : VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     colorBlendAttachment.blendEnable = VK_FALSE;
 
     VkPipelineColorBlendStateCreateInfo colorBlending{};
@@ -585,32 +693,52 @@ void createGraphicsPipeline() {
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment;
 
+    // Nach dem Pre-Pass steht die Tiefe fest, der Farbdurchgang testet nur noch gegen sie
+    const bool depthResolved = depthPrepass && !depthOnly;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = depthResolved ? VK_FALSE : VK_TRUE;
+    depthStencil.depthCompareOp = depthResolved ? VK_COMPARE_OP_LESS_OR_EQUAL : VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
     VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {};
     graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     graphicsPipelineCreateInfo.pNext = nullptr;
-    graphicsPipelineCreateInfo.stageCount = 2;
+    graphicsPipelineCreateInfo.stageCount = depthOnly ? 1 : 2;
     graphicsPipelineCreateInfo.pStages = shaderStages;
     graphicsPipelineCreateInfo.pVertexInputState = &vertexInputInfo;
     graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssembly;
     graphicsPipelineCreateInfo.pViewportState = &viewportState;
     graphicsPipelineCreateInfo.pRasterizationState = &rasterizer;
     graphicsPipelineCreateInfo.pMultisampleState = &multisampling;
+    graphicsPipelineCreateInfo.pDepthStencilState = &depthStencil;
     graphicsPipelineCreateInfo.pColorBlendState = &colorBlending;
     graphicsPipelineCreateInfo.layout = pipelineLayout;
-    graphicsPipelineCreateInfo.renderPass = renderPass;
-    graphicsPipelineCreateInfo.subpass = 0;
 
+    VkPipelineRenderingCreateInfoKHR pipelineRenderingCreateInfo {};
+    renderingContext.preparePipeline(renderingLayout, graphicsPipelineCreateInfo, pipelineRenderingCreateInfo);
+
+    VkPipeline graphicsPipeline;
     if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
         std::cout << "Graphics Pipeline konnte nicht erstellt werden!" << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    if (!depthOnly) {
+        vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    }
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
+
+    return graphicsPipeline;
 }
 
 void createCommandPool() {
 
+    CpuTraceScope traceScope("createCommandPool");
+
     commandPools.resize(swapChainImageViews.size());
 
     VkCommandPoolCreateInfo commandPoolCreateInfo {};
@@ -628,6 +756,8 @@ void createCommandPool() {
 
 void createCommandBuffers() {
 
+    CpuTraceScope traceScope("createCommandBuffers");
+
     commandBuffers.resize(swapChainImageViews.size());
 
     for (size_t x=0; x < commandPools.size(); x++) {
@@ -644,22 +774,96 @@ void createCommandBuffers() {
     }
 }
 
-uint32_t findMemory(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+VkFormat findDepthFormat() {
+
+    // Nach Genauigkeit geordnet, Stencil wird nicht gebraucht
+    const std::array<VkFormat, 4> candidates = {
+        VK_FORMAT_D32_SFLOAT,
+        VK_FORMAT_D32_SFLOAT_S8_UINT,
+        VK_FORMAT_D24_UNORM_S8_UINT,
+        VK_FORMAT_D16_UNORM
+    };
 
-    VkPhysicalDeviceMemoryProperties memoryProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    for (VkFormat format : candidates) {
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
 
-    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
+        if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            return format;
         }
     }
 
-    std::cerr << "Memory type not supported!" << std::endl;
+    std::cerr << "Kein unterstütztes Depth-Format gefunden!" << std::endl;
     std::exit(EXIT_FAILURE);
 }
 
-Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+// Attachments, die den Render Pass nie verlassen. Auf Tile-GPUs belegen sie in Lazily Allocated Memory keinen echten Speicher.
+void createTransientAttachment(VkFormat format, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageAspectFlags aspectMask, VkImage& image, VkDeviceMemory& memory, VkImageView& imageView) {
+
+    VkImageCreateInfo imageCreateInfo {};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.format = format;
+    imageCreateInfo.extent = { width, height, 1 };
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.samples = samples;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.usage = usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(device, &imageCreateInfo, nullptr, &image) != VK_SUCCESS) {
+        std::cerr << "Attachment Image konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device, image, &memoryRequirements);
+
+    // Lazily Allocated, wenn es das gibt, sonst normaler Device Local Speicher
+    if (memoryTypes.allocate(device, memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, memory) != VK_SUCCESS) {
+        std::cerr << "Speicher für das Attachment Image konnte nicht reserviert werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vkBindImageMemory(device, image, memory, 0);
+
+    VkImageViewCreateInfo imageViewCreateInfo {};
+    imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewCreateInfo.image = image;
+    imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    imageViewCreateInfo.format = format;
+    imageViewCreateInfo.subresourceRange.aspectMask = aspectMask;
+    imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+    imageViewCreateInfo.subresourceRange.levelCount = 1;
+    imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+    imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(device, &imageViewCreateInfo, nullptr, &imageView) != VK_SUCCESS) {
+        std::cerr << "Attachment Image View konnte nicht erstellt werden!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void createDepthResources() {
+
+    CpuTraceScope traceScope("createDepthResources");
+
+    depthFormat = findDepthFormat();
+    createTransientAttachment(depthFormat, msaaSamples, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT, depthImage, depthImageMemory, depthImageView);
+}
+
+void createColorResources() {
+
+    CpuTraceScope traceScope("createColorResources");
+
+    if (msaaSamples != VK_SAMPLE_COUNT_1_BIT) {
+        createTransientAttachment(swapChainImageFormat, msaaSamples, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT, colorImage, colorImageMemory, colorImageView);
+    }
+}
+
+Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferredProperties = 0) {
 
     VkBufferCreateInfo vertexBufferCreateInfo {};
     vertexBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -680,16 +884,8 @@ Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropert
     VkMemoryRequirements memoryRequirements;
     vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
 
-    uint32_t memoryTypeIndex = findMemory(memoryRequirements.memoryTypeBits, properties);
-
-    VkMemoryAllocateInfo memoryAllocateInfo {};
-    memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memoryAllocateInfo.pNext = nullptr;
-    memoryAllocateInfo.allocationSize = memoryRequirements.size;
-    memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
-
     VkDeviceMemory memory {};
-    if (vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &memory) != VK_SUCCESS) {
+    if (memoryTypes.allocate(device, memoryRequirements, properties, preferredProperties, memory) != VK_SUCCESS) {
         std::cout << "Memory konnte nicht reserviert werden" << std::endl;
         std::exit(EXIT_FAILURE);
     }
@@ -725,13 +921,13 @@ void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
     copyRegion.dstOffset = 0;
     copyRegion.size = size;
 
-    if (vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
         std::cout << "CommandBuffer kann nicht aufzeichnen" << std::endl;
         std::exit(EXIT_FAILURE);
     }
 
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-    vkEndCommandBuffer(commandBuffer);
+    deviceDispatch.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    deviceDispatch.vkEndCommandBuffer(commandBuffer);
 
     VkSubmitInfo submitInfo {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -744,17 +940,18 @@ void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
     submitInfo.signalSemaphoreCount = 0;
     submitInfo.pSignalSemaphores = nullptr;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+    if (deviceDispatch.vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
         std::cout << "CommandBuffer konnte nicht übermittelt werden" << std::endl;
         std::exit(EXIT_FAILURE);
     };
+    benchmarkCounters.submits++;
 
     vkQueueWaitIdle(graphicsQueue);
     vkFreeCommandBuffers(device, commandPools[0], 1, &commandBuffer);
 }
 
 template<typename T>
-VertexBuffer createDeviceLocalBuffer(std::span<const T> vertices, VkBufferUsageFlags usage) {
+Buffer createDeviceLocalBuffer(std::span<const T> vertices, VkBufferUsageFlags usage) {
 
     const VkDeviceSize size = vertices.size() * sizeof(T);
 
@@ -775,46 +972,175 @@ VertexBuffer createDeviceLocalBuffer(std::span<const T> vertices, VkBufferUsageF
 }
 
 VertexBuffer createVertexBuffer(std::span<const Vertex> vertices) {
-    return createDeviceLocalBuffer(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    return { createDeviceLocalBuffer(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT), computeBounds(vertices) };
 }
 
 IndexBuffer createIndexBuffer(std::span<const uint32_t> indices) {
     return createDeviceLocalBuffer(indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
 }
 
+Mesh createMesh(std::span<const Vertex> vertices, std::span<const uint32_t> indices) {
+    return { createVertexBuffer(vertices), createIndexBuffer(indices), static_cast<uint32_t>(indices.size()) };
+}
+
+void createScene() {
+
+    const uint32_t root = sceneGraph.addNode();
+
+    const float groupSpacing = 2.0f / GROUP_GRID_SIZE;
+    const float leafSpacing = groupSpacing / (LEAF_GRID_SIZE + 2);
+
+    for (uint32_t gy = 0; gy < GROUP_GRID_SIZE; gy++) {
+        for (uint32_t gx = 0; gx < GROUP_GRID_SIZE; gx++) {
+
+            Matrix4f groupLocal;
+            groupLocal.translate(-1.0f + (gx + 0.5f) * groupSpacing, -1.0f + (gy + 0.5f) * groupSpacing, 0.0f);
+
+            const uint32_t group = sceneGraph.addNode(root, groupLocal);
+
+            // Nur jede zweite Gruppe dreht sich, der Rest bleibt sauber und wird nicht neu berechnet
+            if ((gx + gy) % 2 == 0) {
+                spinningGroups.push_back(group);
+            }
+
+            for (uint32_t ly = 0; ly < LEAF_GRID_SIZE; ly++) {
+                for (uint32_t lx = 0; lx < LEAF_GRID_SIZE; lx++) {
+
+                    // Nachbarn überlappen sich in verschiedenen Tiefen, damit der Depth Test etwas zu verwerfen hat
+                    const float layer = static_cast<float>((lx * 3 + ly * 5) % LEAF_GRID_SIZE) / LEAF_GRID_SIZE;
+
+                    Matrix4f leafLocal;
+                    leafLocal.translate((lx - (LEAF_GRID_SIZE - 1) * 0.5f) * leafSpacing, (ly - (LEAF_GRID_SIZE - 1) * 0.5f) * leafSpacing, 0.1f + layer * 0.8f);
+                    leafLocal.scale(leafSpacing * 1.6f, leafSpacing * 1.6f, 1.0f);
+
+                    // Meshes wechseln schachbrettartig, Pipelines pro Gruppenzeile. Unsortiert
+                    // würde dadurch fast jeder Draw einen neuen Vertex Buffer binden.
+                    const uint32_t mesh = (lx + ly) % 2;
+                    const uint32_t pipeline = gy % 2;
+
+                    drawables.push_back({ sceneGraph.addNode(group, leafLocal), mesh, pipeline });
+                }
+            }
+        }
+    }
+}
+
+void updateScene() {
+
+    for (uint32_t group : spinningGroups) {
+        sceneGraph.modifyLocal(group).rotate_z(0.01f);
+    }
+
+    sceneGraph.update();
+
+    sceneGraphFrames++;
+    sceneGraphNodesUpdated += sceneGraph.getStats().nodesUpdated;
+
+    // Kamera schwenkt seitlich, damit ein Teil des Gitters aus dem Bild läuft
+    cameraTime += 0.005f;
+    viewProjection.clear();
+    viewProjection.translate(std::sin(cameraTime), 0.0f, 0.0f);
+}
+
+void cullScene() {
+
+    drawSpheres.clear();
+    for (const Drawable& drawable : drawables) {
+        drawSpheres.push(transformSphere(meshes[drawable.mesh].vertexBuffer.bounds.sphere, sceneGraph.getWorld(drawable.node)));
+    }
+
+    visibleDraws.clear();
+    cullingStats = {};
+    cullSpheres(extractFrustum(viewProjection), drawSpheres, visibleDraws, cullingStats);
+
+    testedDraws += cullingStats.drawsTested;
+    culledDraws += cullingStats.drawsCulled;
+}
+
+void buildRenderQueue() {
+
+    renderQueue.clear();
+
+    for (uint32_t draw : visibleDraws) {
+
+        const Drawable& drawable = drawables[draw];
+        const Mesh& mesh = meshes[drawable.mesh];
+
+        meshPushConstant.transform = viewProjection * sceneGraph.getWorld(drawable.node);
+
+        // Spalte 3 der Transformation ist der Ursprung des Meshes im Clip Space
+        const float* m = meshPushConstant.transform.data();
+        const float depth = m[14] / m[15];
+
+        DrawItem item {};
+        item.pipeline = graphicsPipelines[drawable.pipeline];
+        item.pipelineLayout = pipelineLayout;
+        item.descriptorSet = VK_NULL_HANDLE;
+        item.vertexBuffer = mesh.vertexBuffer.buffer;
+        item.indexBuffer = mesh.indexBuffer.buffer;
+        item.indexCount = mesh.indexCount;
+
+        const uint64_t key = frontToBack ? RenderQueue::makeFrontToBackKey(drawable.pipeline, 0, drawable.mesh, depth) : RenderQueue::makeKey(drawable.pipeline, 0, drawable.mesh, depth);
+        renderQueue.submit(key, item, VK_SHADER_STAGE_VERTEX_BIT, meshPushConstant);
+    }
+
+    renderQueue.sort();
+}
+
 void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 
     VkCommandBufferBeginInfo commandBufferBeginInfo {};
     commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
-    if (vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
         std::cout << "Commandbuffer konnte nicht beginnen!" << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    VkRenderPassBeginInfo renderPassBeginInfo {};
-    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassBeginInfo.renderPass = renderPass;
-    renderPassBeginInfo.framebuffer = framebuffers[imageIndex];
-    renderPassBeginInfo.renderArea.offset = {0, 0};
-    renderPassBeginInfo.renderArea.extent = {width, height};
+    commandRecorder.begin(commandBuffer);
 
-    constexpr VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassBeginInfo.clearValueCount = 1;
-    renderPassBeginInfo.pClearValues = &clearColor;
+    gpuProfiler.beginFrame(commandBuffer, currentFrame);
+    pipelineStatistics.beginFrame(commandBuffer, currentFrame);
+    gpuProfiler.beginScope("Frame");
 
-    VkBuffer vertexBuffers[] = {vertexBuffer.buffer};
-    VkDeviceSize offsets[] = {0};
+    RenderingTargets renderingTargets {};
+    renderingTargets.extent = {width, height};
+    renderingTargets.image = swapChainImages[imageIndex];
+    renderingTargets.imageView = swapChainImageViews[imageIndex];
+    renderingTargets.multisampleImage = colorImage;
+    renderingTargets.multisampleImageView = colorImageView;
+    renderingTargets.depthImage = depthImage;
+    renderingTargets.depthImageView = depthImageView;
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstant), &meshPushConstant);
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-    vkCmdEndRenderPass(commandBuffer);
+    gpuProfiler.beginScope("Render Pass");
+    renderingContext.begin(commandBuffer, renderingLayout, renderingTargets);
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    if (depthPrepass) {
+        pipelineStatistics.beginGroup("Tiefe");
+        renderQueue.recordDepthOnly(commandRecorder, depthPrepassPipeline);
+        pipelineStatistics.endGroup();
+    }
+
+    for (uint32_t pipeline = 0; pipeline < graphicsPipelines.size(); pipeline++) {
+        pipelineStatistics.beginGroup(pipelineNames[pipeline]);
+        renderQueue.record(commandRecorder, pipeline);
+        pipelineStatistics.endGroup();
+    }
+
+    const CommandRecorderStats& recorderStats = commandRecorder.getStats();
+    bindsIssued += recorderStats.bindsIssued();
+    bindsSkipped += recorderStats.bindsSkipped();
+    pushConstantsSkipped += recorderStats.pushConstantsSkipped;
+
+    renderingContext.end(commandBuffer);
+    renderingContext.endFrame();
+    gpuProfiler.endScope();
+
+    gpuProfiler.endScope();
+
+    frameReadback.record(commandBuffer, currentFrame, swapChainImages[imageIndex], headlessOptions.enabled ? OffscreenTargets::FINAL_LAYOUT : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    if (deviceDispatch.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         std::cerr << "Command Buffer konnte nicht aufgezeichnet werden!" << std::endl;
         exit(EXIT_FAILURE);
     }
@@ -822,6 +1148,8 @@ void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 
 void createSyncObjects() {
 
+    CpuTraceScope traceScope("createSyncObjects");
+
     imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
@@ -846,41 +1174,68 @@ void createSyncObjects() {
 
 void drawFrame() {
 
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    CpuTraceScope traceScope("drawFrame");
 
-    uint32_t imageIndex;
-    vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    {
+        CpuTraceScope fenceScope("Fence Wait");
+        deviceDispatch.vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        deviceDispatch.vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    }
 
-    vkResetCommandPool(device, commandPools[currentFrame], 0);
-    recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+    frameReadback.collect(currentFrame);
+
+    // Headless gehört das Offscreen Image fest zum Frame
+    uint32_t imageIndex = currentFrame;
+    if (!headlessOptions.enabled) {
+        CpuTraceScope acquireScope("Acquire");
+        deviceDispatch.vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    }
+
+    {
+        CpuTraceScope resetScope("Reset Command Pool");
+        deviceDispatch.vkResetCommandPool(device, commandPools[currentFrame], 0);
+    }
+
+    {
+        CpuTraceScope recordScope("Record");
+        recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+    }
 
     VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headlessOptions.enabled ? 0 : 1;
     submitInfo.pWaitSemaphores = &imageAvailableSemaphores[currentFrame];
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headlessOptions.enabled ? 0 : 1;
     submitInfo.pSignalSemaphores = &renderFinishedSemaphores[currentFrame];
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-        std::cerr << "Queue Submit fehlgeschlagen!" << std::endl;
-        exit(EXIT_FAILURE);
+    {
+        CpuTraceScope submitScope("Submit");
+        if (deviceDispatch.vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+            std::cerr << "Queue Submit fehlgeschlagen!" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        benchmarkCounters.submits++;
     }
 
-    VkPresentInfoKHR presentInfo {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &renderFinishedSemaphores[currentFrame];;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &swapchain;
-    presentInfo.pImageIndices = &imageIndex;
+    framePacer.frameSubmitted(currentFrame);
+
+    if (!headlessOptions.enabled) {
+        VkPresentInfoKHR presentInfo {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &renderFinishedSemaphores[currentFrame];;
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &swapchain;
+        presentInfo.pImageIndices = &imageIndex;
 
-    vkQueuePresentKHR(graphicsQueue, &presentInfo);
+        CpuTraceScope presentScope("Present");
+        deviceDispatch.vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    }
 
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
@@ -888,8 +1243,9 @@ void drawFrame() {
 
 void cleanup() {
 
-    vertexBuffer.destroy(device);
-    indexBuffer.destroy(device);
+    for (const Mesh& mesh : meshes) {
+        mesh.destroy(device);
+    }
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
@@ -901,90 +1257,274 @@ void cleanup() {
         vkDestroyCommandPool(device, commandPool, nullptr);
     }
 
-    vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    for (VkPipeline graphicsPipeline : graphicsPipelines) {
+        vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    }
+    if (depthPrepassPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, depthPrepassPipeline, nullptr);
+    }
     vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 
-    for (auto framebuffer : framebuffers) {
-        vkDestroyFramebuffer(device, framebuffer, nullptr);
-    }
+    renderingContext.destroy();
 
-    vkDestroyRenderPass(device, renderPass, nullptr);
+    vkDestroyImageView(device, depthImageView, nullptr);
+    vkDestroyImage(device, depthImage, nullptr);
+    memoryTypes.free(device, depthImageMemory);
 
-    for (auto imageView : swapChainImageViews) {
-        vkDestroyImageView(device, imageView, nullptr);
+    if (colorImage != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, colorImageView, nullptr);
+        vkDestroyImage(device, colorImage, nullptr);
+        memoryTypes.free(device, colorImageMemory);
     }
-    vkDestroySwapchainKHR(device, swapchain, nullptr);
+
+    if (headlessOptions.enabled) {
+        offscreenTargets.destroy(device);
+    } else {
+        for (auto imageView : swapChainImageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(device, swapchain, nullptr);
+    }
+
+    frameReadback.destroy();
+    gpuProfiler.destroy();
+    pipelineStatistics.destroy();
 
     vkDestroyDevice(device, nullptr);
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (!headlessOptions.enabled) {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
 
     destroyDebugUtilsMessengerEXT(instance, debugUtilsMessenger, nullptr);
 
     vkDestroyInstance(instance, nullptr);
 }
 
+void renderFrame() {
+
+    // Eingaben und Szene erst abtasten, kurz bevor die GPU den Frame braucht
+    {
+        CpuTraceScope traceScope("Frame Pacing");
+        framePacer.waitForFrame(device, inFlightFences[currentFrame], currentFrame, gpuProfiler.getLatestMs("Frame"));
+    }
+    {
+        CpuTraceScope traceScope("updateScene");
+        updateScene();
+    }
+    {
+        CpuTraceScope traceScope("cullScene");
+        cullScene();
+    }
+    {
+        CpuTraceScope traceScope("buildRenderQueue");
+        buildRenderQueue();
+    }
+    drawFrame();
+}
+
 int main(int argc, char* argv[]) {
 
-    if (!SDL_Init(SDL_INIT_VIDEO)) {
-        std::cout << "SDL konnte nicht initialisiert werden: " << SDL_GetError() << std::endl;
-        return EXIT_FAILURE;
+    headlessOptions = parseHeadlessOptions(argc, argv);
+    goldenImageOptions = parseGoldenImageOptions(argc, argv);
+    captureOptions = parseCaptureOptions(argc, argv);
+    renderingOptions = parseRenderingOptions(argc, argv);
+    framePacerOptions = parseFramePacerOptions(argc, argv);
+
+    // Referenzbilder werden immer ohne Fenster gerendert
+    if (goldenImageOptions.isEnabled()) {
+        headlessOptions.enabled = true;
     }
 
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (std::string(argv[i]) == "--depth-prepass") {
+            depthPrepass = true;
+        } else if (std::string(argv[i]) == "--sort-by-state") {
+            frontToBack = false;
+        } else if (std::string(argv[i]) == "--msaa" && i + 1 < argc) {
+            requestedSamples = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
 
-    SDL_PropertiesID properties = SDL_CreateProperties();
-    SDL_SetStringProperty(properties, SDL_PROP_WINDOW_CREATE_TITLE_STRING, "Hello Vulkan SDL3");
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, 800);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, 600);
-    SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
-    window = SDL_CreateWindowWithProperties(properties);
-    SDL_DestroyProperties(properties);
+    if (!tracePath.empty()) {
+        CpuTrace::enable();
+        CpuTrace::setThreadName("Main");
+    }
 
-    if (!window) {
-        std::cout << "Fenster konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
-        SDL_Quit();
-        return EXIT_FAILURE;
+    if (!headlessOptions.enabled) {
+        if (!SDL_Init(SDL_INIT_VIDEO)) {
+            std::cout << "SDL konnte nicht initialisiert werden: " << SDL_GetError() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+
+        SDL_PropertiesID properties = SDL_CreateProperties();
+        SDL_SetStringProperty(properties, SDL_PROP_WINDOW_CREATE_TITLE_STRING, "Hello Vulkan SDL3");
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_WIDTH_NUMBER, 800);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_HEIGHT_NUMBER, 600);
+        SDL_SetNumberProperty(properties, SDL_PROP_WINDOW_CREATE_FLAGS_NUMBER, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
+        window = SDL_CreateWindowWithProperties(properties);
+        SDL_DestroyProperties(properties);
+
+        if (!window) {
+            std::cout << "Fenster konnte nicht erstellt werden: " << SDL_GetError() << std::endl;
+            SDL_Quit();
+            return EXIT_FAILURE;
+        }
     }
 
     createInstance();
-    createSurface();
+    if (!headlessOptions.enabled) {
+        createSurface();
+    }
     pickPhysicalDevice();
     createDevice();
-    createSwapchain();
-    createImageViews();
-    createRenderPass();
-    createFramebuffers();
+    deviceDispatch.load(device);
+    gpuProfiler.create(deviceCapabilities, device, queueFamilyIndex, MAX_FRAMES_IN_FLIGHT);
+    pipelineStatistics.create(device, pipelineStatisticsSupported, MAX_FRAMES_IN_FLIGHT);
+
+    if (calibratedTimestampsSupported && !gpuProfiler.enableCalibration(instance, physicalDevice)) {
+        std::cout << "GPU-Zeitstempel können nicht kalibriert werden und fehlen im Trace" << std::endl;
+    }
+    if (headlessOptions.enabled) {
+        createOffscreenTargets();
+    } else {
+        createSwapchain();
+        createImageViews();
+    }
+    createDepthResources();
+    createColorResources();
+    createRenderingContext();
     createPipelineLayout();
-    createGraphicsPipeline();
+    graphicsPipelines[0] = createGraphicsPipeline("shaders/triangle.frag.spv");
+    graphicsPipelines[1] = createGraphicsPipeline("shaders/grayscale.frag.spv");
+    if (depthPrepass) {
+        depthPrepassPipeline = createGraphicsPipeline("");
+    }
     createCommandPool();
     createCommandBuffers();
     createSyncObjects();
 
-    vertexBuffer = createVertexBuffer(vertices);
-    indexBuffer = createIndexBuffer(indices);
+    meshes[0] = createMesh(vertices, indices);
+    meshes[1] = createMesh(triangleVertices, triangleIndices);
+
+    createScene();
 
-    bool running = true;
-    SDL_Event event;
+    framePacer.create(framePacerOptions, MAX_FRAMES_IN_FLIGHT);
 
-    SDL_ShowWindow(window);
+    if (goldenImageOptions.isEnabled() || captureOptions.isEnabled()) {
+        frameReadback.create(memoryTypes, device, { width, height }, swapChainImageFormat, MAX_FRAMES_IN_FLIGHT, [](const ReadbackFrame& frame) {
+            if (goldenImageOptions.isEnabled()) {
+                goldenImageTest.capture(frame);
+            }
+            frameCapture.push(frame);
+        });
+    }
 
-    while (running) {
-        while (SDL_PollEvent(&event)) {
+    if (captureOptions.isEnabled()) {
+        frameCapture.start(captureOptions, width, height, swapChainImageFormat);
+    }
+
+    if (!headlessOptions.benchmarkPath.empty()) {
+        runBenchmark("push_constants", device, headlessOptions, gpuProfiler, memoryTypes, renderFrame);
+    } else if (headlessOptions.enabled) {
+        runHeadless(device, headlessOptions.frameCount, renderFrame);
+    } else {
+        SDL_ShowWindow(window);
+
+        // Der Hauptthread verarbeitet nur noch Events, gerendert wird auf dem Render Thread
+        renderThread.start(renderFrame);
+
+        bool running = true;
+        SDL_Event event;
+
+        while (running && SDL_WaitEvent(&event)) {
             if (event.type == SDL_EVENT_QUIT) {
                 running = false;
+            } else if (const std::optional<InputEvent> inputEvent = translateEvent(event)) {
+                renderThread.post(*inputEvent);
             }
         }
 
-        meshPushConstant.transform.rotate_z(0.01);
-        drawFrame();
+        renderThread.stop();
+    }
+
+    // Die letzten Frames in Flight sind noch nicht ausgelesen
+    vkDeviceWaitIdle(device);
+    gpuProfiler.flush();
+    pipelineStatistics.flush();
+
+    int exitCode = EXIT_SUCCESS;
+    if (frameReadback.isEnabled()) {
+        vkDeviceWaitIdle(device);
+        frameReadback.flush();
+        frameCapture.stop();
+
+        if (goldenImageOptions.isEnabled()) {
+            exitCode = goldenImageTest.finish(goldenImageOptions);
+        }
+    }
+
+    if (sceneGraphFrames > 0) {
+        std::cout << "Szenengraph: durchschnittlich " << sceneGraphNodesUpdated / sceneGraphFrames << " von " << sceneGraph.size() << " Knoten pro Frame aktualisiert" << std::endl;
+        std::cout << "Frustum Culling: durchschnittlich " << culledDraws / sceneGraphFrames << " von " << testedDraws / sceneGraphFrames << " Draws pro Frame verworfen" << std::endl;
+        std::cout << "Command Recorder: durchschnittlich " << bindsIssued / sceneGraphFrames << " Binds ausgeführt, " << bindsSkipped / sceneGraphFrames << " übersprungen pro Frame (davon " << pushConstantsSkipped / sceneGraphFrames << " Push Constants)" << std::endl;
+    }
+
+    const FramePacerStats pacerStats = framePacer.getStats();
+    if (pacerStats.samples > 0) {
+        std::cout << "Frame Pacing " << (framePacer.isEnabled() ? "an" : "aus") << ": Latenz avg " << pacerStats.avgLatencyMs << " ms, p99 " << pacerStats.p99LatencyMs << " ms, CPU avg " << pacerStats.avgCpuMs << " ms, geschlafen avg " << pacerStats.avgSleepMs << " ms pro Frame" << std::endl;
+    }
+
+    for (const GpuScopeStats& scope : gpuProfiler.getStats()) {
+        std::cout << "GPU " << scope.name << ": min " << scope.minMs << " ms, avg " << scope.avgMs << " ms, p99 " << scope.p99Ms << " ms (" << scope.samples << " Frames)" << std::endl;
     }
 
-    SDL_HideWindow(window);
+    std::cout << "MSAA: " << msaaSamples << "x (angefordert " << requestedSamples << "x), aufgelöst am Ende des Passes" << std::endl;
+    const RenderPassCacheStats cacheStats = renderingContext.getCacheStats();
+    std::cout << "Rendering: " << (renderingContext.usesDynamicRendering() ? "Dynamic Rendering" : "Render Pass") << ", " << cacheStats.renderPassesCreated << " Render Passes und " << cacheStats.framebuffersCreated << " Framebuffer erstellt, " << cacheStats.renderPassesEvicted + cacheStats.framebuffersEvicted << " verworfen, " << cacheStats.hits << " Treffer im Cache" << std::endl;
+
+    const MemoryTypeStats memoryStats = memoryTypes.getStats();
+    std::cout << "Speicher: " << memoryStats.allocations << " Allokationen, " << memoryStats.fallbacks << " davon ausgewichen, Budget " << (memoryStats.budgetSupported ? "über VK_EXT_memory_budget" : "geschätzt") << std::endl;
+    std::cout << "Tiefe: Format " << depthFormat << ", Pre-Pass " << (depthPrepass ? "an" : "aus") << ", Draws " << (frontToBack ? "von vorne nach hinten" : "nach Zustand") << " sortiert" << std::endl;
+
+    for (const PipelineStatisticsGroup& group : pipelineStatistics.getGroups()) {
+
+        if (group.frames == 0) {
+            continue;
+        }
+
+        // Fragment Shader Aufrufe pro Pixel zeigen den Overdraw der Gruppe
+        const double overdraw = static_cast<double>(group.total.fragmentShaderInvocations) / static_cast<double>(group.frames) / static_cast<double>(width * height);
+
+        std::cout << "Pipeline Statistics " << group.name << " (pro Frame): "
+                  << group.total.inputAssemblyVertices / group.frames << " Vertices, "
+                  << group.total.vertexShaderInvocations / group.frames << " Vertex Shader, "
+                  << group.total.clippingInvocations / group.frames << " Primitive vor dem Clipping, "
+                  << group.total.clippingPrimitives / group.frames << " nach dem Clipping, "
+                  << group.total.fragmentShaderInvocations / group.frames << " Fragment Shader (Overdraw " << overdraw << ")" << std::endl;
+    }
+
+    if (!tracePath.empty()) {
+        if (CpuTrace::writeChromeTrace(tracePath)) {
+            std::cout << "Trace geschrieben: " << tracePath << std::endl;
+        } else {
+            std::cerr << "Trace konnte nicht geschrieben werden: " << tracePath << std::endl;
+        }
+    }
+
+    if (!headlessOptions.enabled) {
+        SDL_HideWindow(window);
+    }
 
     vkDeviceWaitIdle(device);
     cleanup();
 
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    if (!headlessOptions.enabled) {
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+    }
 
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,24 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+struct ObjectData {
+    mat4 world;
+    vec4 sphere;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects {
+    ObjectData objects[];
+};
+
+layout(push_constant) uniform constants {
+    mat4 viewProjection;
+} PushConstants;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = PushConstants.viewProjection * objects[gl_InstanceIndex].world * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor;
+}
@@ -0,0 +1,26 @@
+#version 450
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(set = 0, binding = 0) uniform sampler2D inputImage;
+
+// (1, 0) für horizontal, (0, 1) für vertikal
+layout(push_constant) uniform constants {
+    vec2 direction;
+} PushConstants;
+
+layout(location = 0) out vec4 outColor;
+
+const float weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+void main() {
+    vec2 texelStep = PushConstants.direction / vec2(textureSize(inputImage, 0));
+
+    vec3 color = texture(inputImage, fragTexCoord).rgb * weights[0];
+    for (int i = 1; i < 5; i++) {
+        color += texture(inputImage, fragTexCoord + texelStep * i).rgb * weights[i];
+        color += texture(inputImage, fragTexCoord - texelStep * i).rgb * weights[i];
+    }
+
+    outColor = vec4(color, 1.0);
+}
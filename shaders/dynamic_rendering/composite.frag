@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(set = 0, binding = 0) uniform sampler2D inputImage;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec3 color = texture(inputImage, fragTexCoord).rgb;
+
+    // Zu den Rändern hin abdunkeln
+    vec2 centered = fragTexCoord - 0.5;
+    float vignette = 1.0 - dot(centered, centered) * 1.2;
+
+    outColor = vec4(color * vignette, 1.0);
+}
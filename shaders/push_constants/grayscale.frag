@@ -0,0 +1,10 @@
+#version 450
+
+layout(location = 0) in vec3 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    float luminance = dot(fragColor, vec3(0.299, 0.587, 0.114));
+    outColor = vec4(vec3(luminance), 1.0);
+}